@@ -135,7 +135,7 @@ typedef struct CheckasmTest {
      * and after testing all CPU flags, respectively.
      *
      * @note If CheckasmConfig.repeat > 1, they will be called for every
-     * iteration.
+     * iteration, even with CheckasmConfig.merge_repeats.
      *
      * @warning These are called even when running checkasm_list_functions().
      */
@@ -156,8 +156,42 @@ typedef enum CheckasmFormat {
     CHECKASM_FORMAT_TSV,    /**< Tab-separated values with optional header */
     CHECKASM_FORMAT_JSON,   /**< JSON structured output with all measurement data */
     CHECKASM_FORMAT_HTML,   /**< Interactive HTML report for web viewing */
+    CHECKASM_FORMAT_NDJSON, /**< One JSON object per line, streamed as benchmarks
+                                 complete (since v1.4.0) */
 } CheckasmFormat;
 
+/**
+ * @brief Cache state to benchmark functions in
+ *
+ * Specifies which level of the memory hierarchy the data used by a function
+ * should reside in at the start of each benchmarked call.
+ *
+ * @since v1.4.0
+ */
+typedef enum CheckasmCacheState {
+    CHECKASM_CACHE_HOT,  /**< Data in L1, from repeated calls (default) */
+    CHECKASM_CACHE_L2,   /**< Data evicted from L1, but present in L2 */
+    CHECKASM_CACHE_LLC,  /**< Data evicted from L2, but present in the last level cache */
+    CHECKASM_CACHE_DRAM, /**< Data evicted from all caches */
+} CheckasmCacheState;
+
+/**
+ * @brief Outlier rejection method for benchmark loops
+ *
+ * When inline ASM timers are available, benchmark loops time batches of 32
+ * calls each, and reject batches that were e.g. interrupted or preempted
+ * before summing up the rest. This specifies how such outliers are detected.
+ * Batches are judged in windows of up to #CHECKASM_TRIM_WINDOW at a time.
+ *
+ * @since v1.4.0
+ */
+typedef enum CheckasmOutliers {
+    CHECKASM_OUTLIERS_RATIO, /**< Over 4x the running mean of kept batches (default) */
+    CHECKASM_OUTLIERS_NONE,  /**< Keep all batches */
+    CHECKASM_OUTLIERS_MAD,   /**< Over 3.5 median absolute deviations from the median */
+    CHECKASM_OUTLIERS_TRIM,  /**< The slowest 10% of batches */
+} CheckasmOutliers;
+
 /**
  * @brief Configuration structure for the checkasm test suite
  *
@@ -310,6 +344,321 @@ typedef struct CheckasmConfig {
      * If cpu_affinity_set is nonzero, pin the test process to this CPU core.
      */
     unsigned cpu_affinity;
+
+    /**
+     * @brief Number of worker processes to run tests in
+     *
+     * If greater than 1, tests are distributed across this many forked worker
+     * processes, with each worker running one test (across all CPU flags) at
+     * a time. Results are merged back into the main process before printing
+     * the summary. Values of 0 and 1 both run all tests in-process.
+     *
+     * @note Only supported on systems with fork(). Ignored when benchmarking,
+     *       since concurrent workers would disturb the timing measurements.
+     *
+     * @since v1.4.0
+     */
+    unsigned jobs;
+
+    /**
+     * @brief Run each test in a separate process
+     *
+     * If nonzero, each test is run inside a freshly forked child process. If a
+     * function crashes, the child process is discarded and a new one resumes
+     * the test after the crashed function, so that memory corruption caused
+     * by a misbehaving function can't affect any subsequent results. May be
+     * combined with jobs.
+     *
+     * @note Only supported on systems with fork().
+     *
+     * @since v1.4.0
+     */
+    int isolate;
+
+    /**
+     * @brief Record additional performance counters while benchmarking
+     *
+     * If nonzero, a group of hardware performance counters (instructions,
+     * branch misses, cache misses, ...) is sampled alongside the timer for
+     * every benchmark run, and the per-call averages (as well as the IPC) are
+     * included in the JSON and HTML output. Falls back to software events if
+     * no hardware counters are available.
+     *
+     * @note Only supported on Linux. Enabling this disables the unrolled asm
+     *       benchmark loop, since counters are only read by perf.stop().
+     *
+     * @since v1.4.0
+     */
+    int perf_counters;
+
+    /**
+     * @brief File to save benchmark results to, for later comparison
+     *
+     * If set, the adjusted cycle counts of all benchmarked function versions
+     * are written to this file, along with a fingerprint of the system and
+     * timer used. See compare_baseline.
+     *
+     * @since v1.4.0
+     */
+    const char *save_baseline;
+
+    /**
+     * @brief File to compare benchmark results against
+     *
+     * If set, each benchmark result is compared against the corresponding
+     * entry in this file (as written by save_baseline), and the relative
+     * difference is included in the output. Statistically significant
+     * slowdowns larger than regression_threshold cause checkasm_run() to
+     * return an error.
+     *
+     * @since v1.4.0
+     */
+    const char *compare_baseline;
+
+    /**
+     * @brief Maximum tolerated slowdown vs the baseline, in percent
+     *
+     * Defaults to 5 if zero, unless regression_threshold_set is nonzero, in
+     * which case any significant slowdown is reported as a regression.
+     *
+     * @since v1.4.0
+     */
+    double regression_threshold;
+
+    /** @brief Use the regression_threshold value, even if it is zero
+     *
+     * @since v1.4.0
+     */
+    int regression_threshold_set;
+
+    /**
+     * @brief Target relative error of benchmark results, in percent
+     *
+     * If nonzero, each function is benchmarked until the relative standard
+     * error of its estimate drops below this value, rather than for a fixed
+     * duration.
+     * As a safety net for noisy functions, benchmarking still stops after 10
+     * times bench_usec.
+     *
+     * @since v1.4.0
+     */
+    double bench_precision;
+
+    /**
+     * @brief Additionally benchmark functions with partially cold caches
+     *
+     * If not CHECKASM_CACHE_HOT, each benchmarked function is additionally
+     * timed for a number of single calls, each one preceded by evicting the
+     * caches up to the given level. These results are reported next to the
+     * regular (hot cache) results.
+     *
+     * @note Eviction works by walking a buffer twice the size of the cache
+     *       level being evicted, so this can take a lot longer than regular
+     *       benchmarking, especially for CHECKASM_CACHE_DRAM.
+     *
+     * @since v1.4.0
+     */
+    CheckasmCacheState cache_state;
+
+    /**
+     * @brief Outlier rejection method used by benchmark loops
+     *
+     * The number of rejected batches is reported for each function, so the
+     * quality of the measurements can be audited.
+     *
+     * @see CheckasmOutliers
+     * @since v1.4.0
+     */
+    CheckasmOutliers outliers;
+
+    /**
+     * @brief Additionally measure the latency of all benchmarked functions
+     *
+     * If set, each checkasm_bench() call is additionally timed with calls
+     * issued serially, on the same arguments, such that output buffers are
+     * reused as the next input. Reported next to the regular (throughput)
+     * results. Benchmarks using checkasm_bench_chain() always measure latency.
+     *
+     * @since v1.4.0
+     */
+    int bench_latency;
+
+    /**
+     * @brief Benchmark optimized versions in lockstep with the reference
+     *
+     * If set, the throughput of each version other than the reference (C)
+     * version is measured by alternating timed batches of it and of the
+     * reference, within the same measurement. The reported speedup is then
+     * derived from the log differences of each pair of batches, so that slow
+     * drift (e.g. in clock frequency or background load) cancels out, instead
+     * of dividing two independent measurements taken at different times. The
+     * unpaired ratio is still reported alongside.
+     *
+     * @note This roughly doubles the benchmarking time of optimized versions.
+     * @since v1.4.0
+     */
+    int bench_paired;
+
+    /**
+     * @brief Additionally benchmark functions under multi-core contention
+     *
+     * If greater than 1, each benchmarked function is additionally timed
+     * while the same benchmark loop runs concurrently on this many CPUs in
+     * total, each pinned to a separate CPU (where supported). The mean
+     * per-thread results are reported next to the regular (single-thread)
+     * results, along with the resulting scaling efficiency and the aggregate
+     * throughput of all threads.
+     *
+     * @note Requires fork(); the concurrent loops run in separate processes.
+     * @since v1.4.0
+     */
+    unsigned bench_threads;
+
+    /**
+     * @brief Additionally record the per-call latency distribution
+     *
+     * If set, each benchmarked function that is slow enough for single calls
+     * to be timed reliably is additionally timed for a number of individual
+     * calls, which are collected into a log-bucketed histogram. The resulting
+     * quantiles (p50, p90, p99, p99.9) and maximum are included in the JSON and
+     * HTML reports, to expose tail latencies hidden by the averaged results.
+     *
+     * @since v1.4.0
+     */
+    int bench_quantiles;
+
+    /**
+     * @brief Measure the machine roofline and report efficiency against it
+     *
+     * If set, the sustained memory bandwidth of each cache level and the peak
+     * arithmetic throughput of the CPU are measured once, before running any
+     * tests. For functions declaring their work with checkasm_bench_set_work()
+     * and checkasm_bench_set_ops(), the achieved fraction of the bandwidth
+     * (for the smallest cache level holding the bytes accessed per call) and
+     * of the peak throughput are reported, and the HTML report plots them on
+     * a roofline chart.
+     *
+     * @note The peak throughput is that of a compiler vectorized multiply-add
+     *       loop built for the widest SIMD extension available on x86 (AVX2
+     *       or AVX-512 with FMA). On other architectures it uses the baseline
+     *       instruction set, so hand written kernels may exceed it.
+     *
+     * @since v1.4.0
+     */
+    int roofline;
+
+    /**
+     * @brief Record the CPU clock frequency and temperature during benchmarks
+     *
+     * If set, the current clock frequency (relative to the base frequency) and
+     * temperature are read from the Linux cpufreq and thermal interfaces before
+     * and after each measurement. Measurements during which the clock changed
+     * by more than 5% are repeated a few times, and flagged as unstable if the
+     * clock never settles. The average clock ratio and its drift are reported
+     * per function.
+     *
+     * @note The exact ratio of core to reference cycles is additionally
+     *       reported as part of the performance counters, if enabled.
+     *
+     * @since v1.4.0
+     */
+    int telemetry;
+
+    /**
+     * @brief Root of the sysfs tree read by telemetry and stable_env
+     *
+     * Defaults to "/sys" if NULL. Mainly useful for testing.
+     *
+     * @since v1.4.0
+     */
+    const char *telemetry_root;
+
+    /**
+     * @brief Check and harden the benchmark environment
+     *
+     * If set, the CPU frequency governor, turbo boost state, isolcpus and
+     * nohz_full membership of the benchmarked CPU and the load on its SMT
+     * siblings are checked before benchmarking, and anything likely to hurt
+     * reproducibility is reported. Where permitted, the memory mapped so far is
+     * additionally locked and pre-faulted, and the scheduling priority is
+     * raised. The findings are included in the JSON configuration.
+     *
+     * @note Combine with cpu_affinity, so that the checks apply to the CPU the
+     *       benchmarks actually run on.
+     *
+     * @since v1.4.0
+     */
+    int stable_env;
+
+    /**
+     * @brief File to stream all raw benchmark samples to
+     *
+     * If set, every timed batch of calls from every benchmarked function is
+     * written to this file in a compact binary format (see src/trace.h), with
+     * fixed-size records tagged by function version, timestamp and CPU. The
+     * file can be memory mapped and processed without any parsing.
+     *
+     * @since v1.4.0
+     */
+    const char *trace_file;
+
+    /**
+     * @brief File to record finished benchmark results in
+     *
+     * If set, the results of each function version are durably written to
+     * this file as soon as its report group has finished, so that a long run
+     * which gets interrupted can be continued later with `resume`. Unless
+     * resuming, an existing file is never overwritten; it has to be removed
+     * first.
+     *
+     * @since v1.4.0
+     */
+    const char *checkpoint_file;
+
+    /**
+     * @brief Continue from the results recorded in checkpoint_file
+     *
+     * Function versions which already have results for the same test name,
+     * function name, version suffix and seed are still tested for correctness,
+     * but not benchmarked again; their saved results are reported instead.
+     * The checkpoint must have been written by the same build of checkasm on
+     * the same system. Requires checkpoint_file to be set; a missing file is
+     * not an error.
+     *
+     * @since v1.4.0
+     */
+    int resume;
+
+    /**
+     * @brief Combine the results of all repeat iterations
+     *
+     * If set, functions and their benchmark results are kept across repeat
+     * iterations rather than starting over for each seed. Every iteration
+     * still tests all functions, but the measurements of each iteration are
+     * accumulated into the same results, with the spread between iterations
+     * included in their error estimates. A single benchmark table is printed
+     * after the last iteration (or when interrupted).
+     *
+     * @note Ignored with jobs or isolate, since functions are merged back
+     *       from the child processes after each test. Benchmark results can't
+     *       be saved to checkpoint_file, as they are never final.
+     *
+     * @since v1.4.0
+     */
+    int merge_repeats;
+
+    /**
+     * @brief Generate the same checkasm_init() data as earlier versions
+     *
+     * By default, checkasm_init() and checkasm_init_mask8/16() pick each run of
+     * a test pattern once and then fill it in bulk. This draws fewer random
+     * numbers than the per-element generator used before v1.4.0, so the same
+     * seed produces different data. If set, the old generator is used instead,
+     * e.g. to reproduce a failure reported for an older version.
+     *
+     * @since v1.4.0
+     */
+    int exact_init;
 } CheckasmConfig;
 
 /**
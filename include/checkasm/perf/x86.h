@@ -41,11 +41,47 @@ static inline uint64_t checkasm_rdtsc(void)
     __asm__ __volatile__("lfence\nrdtsc" : "=a"(eax), "=d"(edx));
     return (((uint64_t) edx) << 32) | eax;
 }
+
+/* Fields of the mmap()ed perf_event_mmap_page of a Linux perf event, used to
+ * read the core cycle counter directly from userspace */
+typedef struct CheckasmRdpmc {
+    const volatile uint32_t *lock;
+    const volatile uint32_t *index;
+    const volatile int64_t  *offset;
+    int                      width;
+} CheckasmRdpmc;
+
+static inline uint64_t checkasm_rdpmc(const CheckasmRdpmc *const pmc)
+{
+    uint32_t seq, idx;
+    uint64_t count;
+    do {
+        seq = *pmc->lock;
+        __asm__ __volatile__("" ::: "memory");
+        idx   = *pmc->index;
+        count = (uint64_t) *pmc->offset;
+        if (idx) {
+            uint32_t   eax, edx;
+            const int  shift = 64 - pmc->width;
+            __asm__ __volatile__("lfence\nrdpmc" : "=a"(eax), "=d"(edx) : "c"(idx - 1));
+            count += (uint64_t) ((int64_t) ((((uint64_t) edx) << 32 | eax) << shift)
+                                 >> shift);
+        }
+        __asm__ __volatile__("" ::: "memory");
+    } while (*pmc->lock != seq);
+    return count;
+}
+
+  /* Alternative to CHECKASM_PERF_ASM(), if the perf backend mapped a counter */
+  #define CHECKASM_PERF_RDPMC(pmc) checkasm_rdpmc(pmc)
 #endif
 
-#define CHECKASM_PERF_ASM()      checkasm_rdtsc()
-#define CHECKASM_PERF_ASM_NAME   "x86 (rdtsc)"
-#define CHECKASM_PERF_ASM_UNIT   "cycle"
-#define CHECKASM_PERF_ASM_USABLE 1
+#define CHECKASM_PERF_ASM()    checkasm_rdtsc()
+#define CHECKASM_PERF_ASM_NAME "x86 (rdtsc)"
+#define CHECKASM_PERF_ASM_UNIT "cycle"
+#ifdef _WIN32
+  /* Can't be probed without signal handlers here, but rdtsc always exists */
+  #define CHECKASM_PERF_ASM_USABLE 1
+#endif
 
 #endif /* CHECKASM_PERF_X86_H */
@@ -381,6 +381,59 @@ static CheckasmKey checkasm_key_new;
  */
 #define checkasm_call_new(...) checkasm_call_checked(checkasm_func_new, __VA_ARGS__)
 
+/**
+ * @brief Set the amount of work done per call of the benchmarked function
+ *
+ * Applies to all subsequent checkasm_bench() and checkasm_bench_new() calls
+ * within the current checkasm_check_func() block. When set, benchmark reports
+ * additionally include the time per element, the number of elements processed
+ * per second and the effective memory bandwidth, making functions operating on
+ * different block sizes comparable to each other.
+ *
+ * If the benchmark is run multiple times with different amounts of work, the
+ * per-element figures are accumulated as a geometric mean, just like the
+ * timing results themselves.
+ *
+ * @param[in] bytes Number of bytes read and written per call, or 0 if unknown
+ * @param[in] elements Number of elements (e.g. pixels) processed per call, or
+ *                     0 if unknown
+ *
+ * @code
+ * checkasm_bench_set_work(2 * w * h * sizeof(pixel), w * h);
+ * checkasm_bench_new(dst, dst_stride, src, src_stride, w, h);
+ * @endcode
+ *
+ * @since v1.4.0
+ */
+CHECKASM_API void checkasm_bench_set_work(uint64_t bytes, uint64_t elements);
+
+/**
+ * @brief Set the number of arithmetic operations per call of the benchmarked
+ *        function
+ *
+ * Like checkasm_bench_set_work(), this applies to all subsequent benchmarks
+ * within the current checkasm_check_func() block, and is accumulated as a
+ * geometric mean. When set, benchmark reports additionally include the number
+ * of operations per second. Together with the number of bytes, this places the
+ * function on the roofline model (see CheckasmConfig.roofline).
+ *
+ * Count the operations of the reference algorithm (e.g. one multiply and one
+ * add per tap of a filter), not the instructions of any particular
+ * implementation, so that all versions are measured against the same amount of
+ * work.
+ *
+ * @param[in] ops Number of arithmetic operations per call, or 0 if unknown
+ *
+ * @code
+ * checkasm_bench_set_work(2 * w * h * sizeof(pixel), w * h);
+ * checkasm_bench_set_ops(2 * taps * w * h);
+ * checkasm_bench_new(dst, dst_stride, src, src_stride, w, h);
+ * @endcode
+ *
+ * @since v1.4.0
+ */
+CHECKASM_API void checkasm_bench_set_ops(uint64_t ops);
+
 /**
  * @def checkasm_bench(func, ...)
  * @brief Benchmark a function
@@ -401,24 +454,83 @@ static CheckasmKey checkasm_key_new;
  * @see checkasm_bench_new(), checkasm_alternate()
  */
 #define checkasm_bench(func, ...)                                                        \
-    do {                                                                                 \
-        if (checkasm_bench_func()) {                                                     \
-            func_type *const bench_func = (func);                                        \
-            checkasm_set_signal_handler_state(1);                                        \
-            for (int truns; (truns = checkasm_bench_runs());) {                          \
-                uint64_t time;                                                           \
-                CHECKASM_PERF_BENCH(truns, time, __VA_ARGS__);                           \
-                checkasm_clear_cpu_state();                                              \
-                checkasm_bench_update(truns, time);                                      \
-            }                                                                            \
-            checkasm_set_signal_handler_state(0);                                        \
-            checkasm_bench_finish();                                                     \
-        } else {                                                                         \
-            const int tidx = 0;                                                          \
-            (void) tidx;                                                                 \
-            checkasm_call_checked(func, __VA_ARGS__);                                    \
-        }                                                                                \
-    } while (0)
+    CHECKASM_BENCH(func, checkasm_bench_func, CHECKASM_SINK_VOID, __VA_ARGS__)
+
+/**
+ * @def checkasm_bench_latency(func, ...)
+ * @brief Benchmark a function, including its latency
+ *
+ * Like checkasm_bench(), but additionally measures the latency of a chain of
+ * serially dependent calls, as if CheckasmConfig.bench_latency was set. This is
+ * reported next to the regular (reciprocal throughput) results.
+ *
+ * While measuring latency, checkasm_alternate() always returns its first
+ * argument, so output buffers passed as input are reused by the next call.
+ *
+ * @param func Function pointer to benchmark
+ * @param ... Arguments to pass to the function
+ *
+ * @code
+ * // Each call's output is the next call's input
+ * checkasm_bench_latency_new(buf, buf, w);
+ * @endcode
+ *
+ * @see checkasm_bench(), checkasm_bench_chain()
+ * @since v1.4.0
+ */
+#define checkasm_bench_latency(func, ...)                                                \
+    CHECKASM_BENCH(func, checkasm_bench_latency_func, CHECKASM_SINK_VOID, __VA_ARGS__)
+
+/**
+ * @def checkasm_bench_chain(func, ...)
+ * @brief Benchmark a function, including the latency of its return value
+ *
+ * Like checkasm_bench_latency(), for functions returning a scalar value. Any
+ * arguments wrapped in checkasm_chain() additionally depend on the return
+ * value of the previous call while measuring latency.
+ *
+ * @param func Function pointer to benchmark
+ * @param ... Arguments to pass to the function
+ *
+ * @code
+ * // Each call waits on the previous call's return value
+ * checkasm_bench_chain_new(checkasm_chain(src), stride, ref, stride);
+ * @endcode
+ *
+ * @see checkasm_bench_latency(), checkasm_chain()
+ * @since v1.4.0
+ */
+#define checkasm_bench_chain(func, ...)                                                  \
+    CHECKASM_BENCH(func, checkasm_bench_latency_func, CHECKASM_SINK_CHAIN, __VA_ARGS__)
+
+/**
+ * @def checkasm_bench_latency_new(...)
+ * @brief Benchmark the optimized implementation, including its latency
+ * @see checkasm_bench_latency(), checkasm_bench_new()
+ * @since v1.4.0
+ */
+#define checkasm_bench_latency_new(...)                                                  \
+    checkasm_bench_latency(checkasm_func_new, __VA_ARGS__)
+
+/**
+ * @def checkasm_bench_chain_new(...)
+ * @brief Benchmark the optimized implementation, including its return latency
+ * @see checkasm_bench_chain(), checkasm_bench_new()
+ * @since v1.4.0
+ */
+#define checkasm_bench_chain_new(...) checkasm_bench_chain(checkasm_func_new, __VA_ARGS__)
+
+/**
+ * @def checkasm_chain(x)
+ * @brief Make a benchmark argument depend on the previous call's return value
+ *
+ * Evaluates to `x`, but while measuring latency, with a data dependency on the
+ * return value of the previous call. Only valid within checkasm_bench_chain().
+ *
+ * @param x Pointer or integer argument
+ * @since v1.4.0
+ */
+#define checkasm_chain(x) ((x) + tchain)
 
 /**
  * @def checkasm_bench_new(...)
@@ -453,7 +565,8 @@ static CheckasmKey checkasm_key_new;
  * Returns one of two values, alternating between them across benchmark
  * iterations. Intended for use within bench_new() calls for functions that
  * modify their input buffers. This ensures throughput (not latency) is
- * measured by preventing data dependencies between iterations.
+ * measured by preventing data dependencies between iterations. While measuring
+ * latency (see checkasm_bench_latency()), the first value is always returned.
  *
  * @param a First value
  * @param b Second value
@@ -550,6 +663,11 @@ typedef struct CheckasmPerf {
     /** @brief Whether inline ASM timing instructions are usable */
     int asm_usable;
 #endif
+
+#ifdef CHECKASM_PERF_RDPMC
+    /** @brief If set, CHECKASM_PERF_RDPMC() is used instead of CHECKASM_PERF_ASM() */
+    const CheckasmRdpmc *rdpmc;
+#endif
 } CheckasmPerf;
 
 #define CHECKASM_PERF_CALL4(...)                                                         \
@@ -583,21 +701,58 @@ typedef struct CheckasmPerf {
         time = perf.stop(time);                                                          \
     } while (0)
 
-/* Unrolled loop with inline outlier rejection; used when we have asm cycle counters */
-#define CHECKASM_PERF_BENCH_ASM(total_count, time, ...)                                  \
+/* Serially dependent calls on the same arguments, for measuring latency */
+#define CHECKASM_PERF_BENCH_SERIAL(count, time, sink, ...)                               \
     do {                                                                                 \
-        int      tcount_trim = 0;                                                        \
+        const CheckasmPerf perf = *checkasm_get_perf();                                  \
+        const int          tidx = 0;                                                     \
+        (void) tidx;                                                                     \
+        time = perf.start();                                                             \
+        for (int titer = 0; titer < count; titer++)                                      \
+            sink(bench_func(__VA_ARGS__));                                               \
+        time = perf.stop(time);                                                          \
+    } while (0)
+
+/**
+ * @brief Maximum number of timed batches passed to checkasm_bench_trim() at once
+ */
+#define CHECKASM_TRIM_WINDOW 64
+
+/**
+ * @brief Reject outliers from a window of timed batches
+ *
+ * Adds the batches not rejected by CheckasmConfig.outliers to the running
+ * sum and count, and keeps track of the number of rejected batches.
+ *
+ * @param[in] times Timings of up to #CHECKASM_TRIM_WINDOW batches
+ * @param[in] nb Number of batches
+ * @param[in,out] sum Sum of kept batches
+ * @param[in,out] count Number of kept batches
+ */
+CHECKASM_API void checkasm_bench_trim(const uint64_t *times, int nb, uint64_t *sum,
+                                      int *count);
+
+/* Unrolled loop with outlier rejection; used when we have asm cycle counters, read
+ * by `timer`. The first batch is always discarded as warm-up, unless there are very
+ * few */
+#define CHECKASM_PERF_BENCH_ASM(timer, total_count, time, ...)                           \
+    do {                                                                                 \
+        uint64_t ttimes[CHECKASM_TRIM_WINDOW];                                           \
         uint64_t tsum_trim   = 0;                                                        \
+        int      tcount_trim = 0, tnb_trim = 0;                                          \
         for (int titer = 0; titer < total_count; titer += 32) {                          \
-            uint64_t t = CHECKASM_PERF_ASM();                                            \
+            uint64_t t = timer;                                                          \
             CHECKASM_PERF_CALL16(__VA_ARGS__);                                           \
             CHECKASM_PERF_CALL16(__VA_ARGS__);                                           \
-            t = CHECKASM_PERF_ASM() - t;                                                 \
-            if (t * tcount_trim <= tsum_trim * 4 && (titer > 0 || total_count < 1000)) { \
-                tsum_trim += t;                                                          \
-                tcount_trim++;                                                           \
+            t = timer - t;                                                               \
+            if (titer > 0 || total_count < 1000)                                         \
+                ttimes[tnb_trim++] = t;                                                  \
+            if (tnb_trim == CHECKASM_TRIM_WINDOW) {                                      \
+                checkasm_bench_trim(ttimes, tnb_trim, &tsum_trim, &tcount_trim);         \
+                tnb_trim = 0;                                                            \
             }                                                                            \
         }                                                                                \
+        checkasm_bench_trim(ttimes, tnb_trim, &tsum_trim, &tcount_trim);                 \
         time        = tsum_trim;                                                         \
         total_count = tcount_trim << 5;                                                  \
     } while (0)
@@ -609,11 +764,27 @@ CHECKASM_API const CheckasmPerf *checkasm_get_perf(void);
   #ifndef CHECKASM_PERF_ASM_USABLE
     #define CHECKASM_PERF_ASM_USABLE perf.asm_usable
   #endif
+  #ifdef CHECKASM_PERF_RDPMC
+    /* Pick the counter once, so the timed loop itself never branches on it */
+    #define CHECKASM_PERF_BENCH_TIMER(count, time, ...)                                  \
+        do {                                                                             \
+            const CheckasmRdpmc *const tpmc = perf.rdpmc;                                \
+            if (tpmc) {                                                                  \
+                CHECKASM_PERF_BENCH_ASM(CHECKASM_PERF_RDPMC(tpmc), count, time,          \
+                                        __VA_ARGS__);                                    \
+            } else {                                                                     \
+                CHECKASM_PERF_BENCH_ASM(CHECKASM_PERF_ASM(), count, time, __VA_ARGS__);  \
+            }                                                                            \
+        } while (0)
+  #else
+    #define CHECKASM_PERF_BENCH_TIMER(count, time, ...)                                  \
+        CHECKASM_PERF_BENCH_ASM(CHECKASM_PERF_ASM(), count, time, __VA_ARGS__)
+  #endif
   #define CHECKASM_PERF_BENCH(count, time, ...)                                          \
       do {                                                                               \
           const CheckasmPerf perf = *checkasm_get_perf();                                \
           if (CHECKASM_PERF_ASM_USABLE && count >= 128) {                                \
-              CHECKASM_PERF_BENCH_ASM(count, time, __VA_ARGS__);                         \
+              CHECKASM_PERF_BENCH_TIMER(count, time, __VA_ARGS__);                       \
           } else {                                                                       \
               CHECKASM_PERF_BENCH_SIMPLE(count, time, __VA_ARGS__);                      \
           }                                                                              \
@@ -626,6 +797,31 @@ CHECKASM_API const CheckasmPerf *checkasm_get_perf(void);
       } while (0)
 #endif
 
+/* Alternates batches of bench_func and the reference (if non-NULL), starting with
+ * either in turn; the reference batch is passed to checkasm_bench_update_paired() */
+#define CHECKASM_PERF_BENCH_PAIRED(ref, count, time, ...)                                \
+    do {                                                                                 \
+        func_type *const tnew       = bench_func;                                        \
+        const int        tsides     = (ref) ? 2 : 1;                                     \
+        int              tcounts[2] = { count, count };                                  \
+        uint64_t         tcycles[2] = { 0, 0 };                                          \
+        tpair = tsides > 1 && !tpair;                                                    \
+        for (int tside = 0; tside < tsides; tside++) {                                   \
+            const int tis_ref = tside ^ tpair;                                           \
+            if (tside)                                                                   \
+                checkasm_clear_cpu_state();                                              \
+            bench_func = tis_ref ? (ref) : tnew;                                         \
+            if (tsides > 1)                                                              \
+                checkasm_bench_paired_side(tis_ref);                                     \
+            CHECKASM_PERF_BENCH(tcounts[tis_ref], tcycles[tis_ref], __VA_ARGS__);        \
+        }                                                                                \
+        bench_func = tnew;                                                               \
+        count      = tcounts[0];                                                         \
+        time       = tcycles[0];                                                         \
+        if (tsides > 1)                                                                  \
+            checkasm_bench_update_paired(tcounts[1], tcycles[1]);                        \
+    } while (0)
+
 /**
  * @brief Check if current function should be benchmarked
  * @return Non-zero if benchmarking is enabled for the current function
@@ -650,6 +846,88 @@ CHECKASM_API void checkasm_bench_update(int iterations, uint64_t cycles);
  */
 CHECKASM_API void checkasm_bench_finish(void);
 
+/**
+ * @brief Same as checkasm_bench_func(), but also requests latency measurements
+ */
+CHECKASM_API int checkasm_bench_latency_func(void);
+
+/**
+ * @brief Check if the current benchmark run should measure latency
+ * @return Non-zero if the calls should be serially dependent
+ */
+CHECKASM_API int checkasm_bench_serial(void);
+
+/**
+ * @brief Get the reference version to benchmark in lockstep with a function
+ * @param[in] key Function being benchmarked
+ * @return Reference version to alternate batches with, or 0 if not pairing
+ */
+CHECKASM_API CheckasmKey checkasm_bench_paired(CheckasmKey key);
+
+/**
+ * @brief Mark the batches timed next as belonging to either side of a pairing
+ *
+ * Outliers rejected on the reference side are not counted for the function
+ * being measured. Reset by checkasm_bench_update_paired().
+ *
+ * @param[in] is_ref Non-zero for the reference side
+ */
+CHECKASM_API void checkasm_bench_paired_side(int is_ref);
+
+/**
+ * @brief Record the reference batch paired with the next checkasm_bench_update()
+ * @param[in] iterations Number of iterations of the reference that were run
+ * @param[in] cycles Sum of elapsed time/cycles for those iterations
+ */
+CHECKASM_API void checkasm_bench_update_paired(int iterations, uint64_t cycles);
+
+/**
+ * @brief Return zero, with a data dependency on the given value
+ */
+static inline intptr_t checkasm_dependency(const intptr_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    intptr_t y = x;
+    __asm__("" : "+r"(y));
+    return y - x;
+#else
+    const volatile intptr_t y = x;
+    return y - x;
+#endif
+}
+
+#define CHECKASM_SINK_VOID(call)  call
+#define CHECKASM_SINK_CHAIN(call) tchain = checkasm_dependency((intptr_t) (call))
+
+#define CHECKASM_BENCH(func, bench_check, sink, ...)                                     \
+    do {                                                                                 \
+        intptr_t tchain = 0;                                                             \
+        (void) tchain;                                                                   \
+        if (bench_check()) {                                                             \
+            func_type *bench_func = (func);                                              \
+            int        tpair      = 0;                                                   \
+            checkasm_set_signal_handler_state(1);                                        \
+            for (int truns; (truns = checkasm_bench_runs());) {                          \
+                uint64_t time;                                                           \
+                if (checkasm_bench_serial()) {                                           \
+                    CHECKASM_PERF_BENCH_SERIAL(truns, time, sink, __VA_ARGS__);          \
+                } else {                                                                 \
+                    func_type *const tref                                                \
+                        = (func_type *) checkasm_bench_paired((CheckasmKey) bench_func); \
+                    CHECKASM_PERF_BENCH_PAIRED(tref, truns, time, __VA_ARGS__);          \
+                }                                                                        \
+                checkasm_clear_cpu_state();                                              \
+                checkasm_bench_update(truns, time);                                      \
+            }                                                                            \
+            checkasm_set_signal_handler_state(0);                                        \
+            checkasm_bench_finish();                                                     \
+        } else {                                                                         \
+            const int tidx = 0;                                                          \
+            (void) tidx;                                                                 \
+            checkasm_call_checked(func, __VA_ARGS__);                                    \
+        }                                                                                \
+    } while (0)
+
 /**
  * @brief Suppress unused variable warnings
  */
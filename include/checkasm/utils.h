@@ -346,6 +346,61 @@ CHECKASM_API void checkasm_init_mask16(uint16_t *buf, int width, uint16_t mask);
  */
 #define INITIALIZE_BUF(buf) checkasm_init(buf, sizeof(buf))
 
+/**
+ * @brief Which end of a guarded buffer is placed against a guard page
+ * @see checkasm_alloc_guarded()
+ * @since v1.4.0
+ */
+typedef enum CheckasmGuard {
+    CHECKASM_GUARD_END,   /**< Catch accesses past the end of the buffer */
+    CHECKASM_GUARD_START, /**< Catch accesses before the start of the buffer */
+} CheckasmGuard;
+
+/**
+ * @brief Allocate a buffer directly next to an inaccessible guard page
+ *
+ * Unlike the padding checks of checkasm_check_padded(), which only notice
+ * out-of-bounds writes that change a byte, this also catches out-of-bounds
+ * reads: the buffer is surrounded by pages that can't be read or written,
+ * and one end of the buffer is placed directly against one of them. Any
+ * access to a guard page is reported as an out-of-bounds read or write (or
+ * just "access", on platforms where that can't be told apart) for the
+ * function version currently being tested, just like any other crash.
+ *
+ * The contents of the buffer are undefined. Free it with
+ * checkasm_free_guarded().
+ *
+ * @note With #CHECKASM_GUARD_END, there is a gap of up to `align - 1` bytes
+ *       between the end of the buffer and the guard page, unless `size` is a
+ *       multiple of `align`. Accesses within that gap are not caught. If the
+ *       platform doesn't support protecting pages, this returns a regular
+ *       aligned buffer without any guard pages.
+ *
+ * @param[in] size Size of the buffer in bytes
+ * @param[in] align Alignment of the buffer in bytes, a power of two no larger
+ *                  than the page size (0 for no alignment)
+ * @param[in] side Which end of the buffer to place against a guard page
+ * @return Pointer to the buffer, exits on allocation failure
+ *
+ * @code
+ * // Catch reads past the end of a 1920 pixel row
+ * uint8_t *src = checkasm_alloc_guarded(1920, 1, CHECKASM_GUARD_END);
+ * checkasm_init(src, 1920);
+ * checkasm_call_new(dst, src, 1920);
+ * checkasm_free_guarded(src);
+ * @endcode
+ *
+ * @since v1.4.0
+ */
+CHECKASM_API void *checkasm_alloc_guarded(size_t size, size_t align, CheckasmGuard side);
+
+/**
+ * @brief Free a buffer allocated by checkasm_alloc_guarded()
+ * @param[in] ptr Buffer to free, or NULL
+ * @since v1.4.0
+ */
+CHECKASM_API void checkasm_free_guarded(void *ptr);
+
 /** @} */ /* memory */
 
 /**
@@ -0,0 +1,178 @@
+/*
+ * Copyright © 2025, Niklas Haas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "baseline.h"
+#include "internal.h"
+
+/* Bumped whenever the file format changes incompatibly */
+#define BASELINE_HEADER "checkasm baseline v1"
+
+void checkasm_baseline_uninit(CheckasmBaseline *baseline)
+{
+    for (int i = 0; i < baseline->nb_entries; i++) {
+        free(baseline->entries[i].name);
+        free(baseline->entries[i].suffix);
+    }
+    free(baseline->entries);
+    free(baseline->fingerprint);
+    memset(baseline, 0, sizeof(*baseline));
+}
+
+void checkasm_baseline_add(CheckasmBaseline *baseline, const char *name,
+                           const char *suffix, const CheckasmVar cycles,
+                           const int nb_samples)
+{
+    if (baseline->nb_entries == baseline->size) {
+        baseline->size    = baseline->size ? 2 * baseline->size : 64;
+        baseline->entries = checkasm_handle_oom(
+            realloc(baseline->entries, baseline->size * sizeof(*baseline->entries)));
+    }
+
+    baseline->entries[baseline->nb_entries++] = (CheckasmBaselineEntry) {
+        .name       = checkasm_strdup(name),
+        .suffix     = checkasm_strdup(suffix),
+        .cycles     = cycles,
+        .nb_samples = nb_samples,
+    };
+}
+
+static int cmp_entries(const void *a, const void *b)
+{
+    const CheckasmBaselineEntry *ea = a, *eb = b;
+    const int cmp = strcmp(ea->name, eb->name);
+    return cmp ? cmp : strcmp(ea->suffix, eb->suffix);
+}
+
+const CheckasmBaselineEntry *checkasm_baseline_find(const CheckasmBaseline *baseline,
+                                                    const char *name, const char *suffix)
+{
+    if (!baseline->nb_entries)
+        return NULL;
+
+    const CheckasmBaselineEntry key = { .name = (char *) name, .suffix = (char *) suffix };
+    return bsearch(&key, baseline->entries, baseline->nb_entries,
+                   sizeof(*baseline->entries), cmp_entries);
+}
+
+int checkasm_baseline_write(const CheckasmBaseline *baseline, const char *path)
+{
+    FILE *const f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "checkasm: failed to open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    fprintf(f, "%s\n", BASELINE_HEADER);
+    fprintf(f, "fingerprint\t%s\n", baseline->fingerprint ? baseline->fingerprint : "");
+    for (int i = 0; i < baseline->nb_entries; i++) {
+        const CheckasmBaselineEntry *e = &baseline->entries[i];
+        fprintf(f, "%s\t%s\t%.17g\t%.17g\t%d\n", e->name, e->suffix, e->cycles.lmean,
+                e->cycles.lvar, e->nb_samples);
+    }
+
+    if (fclose(f)) {
+        fprintf(stderr, "checkasm: failed to write %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    return 0;
+}
+
+/* Split off the next tab-separated field, in-place */
+static char *next_field(char **const str)
+{
+    char *const field = *str;
+    if (!field)
+        return NULL;
+
+    char *const tab = strchr(field, '\t');
+    if (tab)
+        *tab = '\0';
+    *str = tab ? tab + 1 : NULL;
+    return field;
+}
+
+int checkasm_baseline_read(CheckasmBaseline *baseline, const char *path)
+{
+    FILE *const f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "checkasm: failed to open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    char line[1024];
+    int  line_nr = 1;
+    if (!fgets(line, sizeof(line), f) || strcmp(line, BASELINE_HEADER "\n"))
+        goto fail;
+
+    line_nr++;
+    if (!fgets(line, sizeof(line), f) || strncmp(line, "fingerprint\t", 12))
+        goto fail;
+    line[strcspn(line, "\n")] = '\0';
+    free(baseline->fingerprint);
+    baseline->fingerprint = checkasm_strdup(line + 12);
+
+    while (fgets(line, sizeof(line), f)) {
+        char *rest = line;
+        line_nr++;
+        rest[strcspn(rest, "\n")] = '\0';
+
+        char *const name    = next_field(&rest);
+        char *const suffix  = next_field(&rest);
+        char *const lmean   = next_field(&rest);
+        char *const lvar    = next_field(&rest);
+        char *const samples = next_field(&rest);
+        if (!samples || rest)
+            goto fail;
+
+        char       *end[3];
+        CheckasmVar cycles = {
+            .lmean = strtod(lmean, &end[0]),
+            .lvar  = strtod(lvar, &end[1]),
+        };
+        const long nb_samples = strtol(samples, &end[2], 10);
+        if (*end[0] || *end[1] || *end[2] || end[0] == lmean || end[1] == lvar
+            || end[2] == samples)
+            goto fail;
+
+        checkasm_baseline_add(baseline, name, suffix, cycles, (int) nb_samples);
+    }
+
+    fclose(f);
+    qsort(baseline->entries, baseline->nb_entries, sizeof(*baseline->entries),
+          cmp_entries);
+    return 0;
+
+fail:
+    fprintf(stderr, "checkasm: %s:%d: invalid baseline file\n", path, line_nr);
+    fclose(f);
+    checkasm_baseline_uninit(baseline);
+    return 1;
+}
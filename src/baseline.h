@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2025, Niklas Haas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CHECKASM_BASELINE_H
+#define CHECKASM_BASELINE_H
+
+#include "stats.h"
+
+/* Benchmark results of a previous run, see --save-baseline and --compare */
+typedef struct CheckasmBaselineEntry {
+    char       *name;   /* function name */
+    char       *suffix; /* version suffix */
+    CheckasmVar cycles; /* adjusted cycles */
+    int         nb_samples;
+} CheckasmBaselineEntry;
+
+typedef struct CheckasmBaseline {
+    CheckasmBaselineEntry *entries;
+    int                    nb_entries;
+    int                    size;
+    char                  *fingerprint; /* describes the system and timer */
+} CheckasmBaseline;
+
+void checkasm_baseline_uninit(CheckasmBaseline *baseline);
+void checkasm_baseline_add(CheckasmBaseline *baseline, const char *name,
+                           const char *suffix, CheckasmVar cycles, int nb_samples);
+
+/* Returns NULL if there is no entry for this function version. Only valid for
+ * baselines loaded by checkasm_baseline_read(), which sorts the entries */
+const CheckasmBaselineEntry *checkasm_baseline_find(const CheckasmBaseline *baseline,
+                                                    const char *name, const char *suffix);
+
+/* Returns 0 on success, prints an error message otherwise */
+int checkasm_baseline_write(const CheckasmBaseline *baseline, const char *path);
+int checkasm_baseline_read(CheckasmBaseline *baseline, const char *path);
+
+#endif /* CHECKASM_BASELINE_H */
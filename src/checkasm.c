@@ -47,11 +47,15 @@
 
 #include "checkasm/checkasm.h"
 #include "checkasm/test.h"
+#include "baseline.h"
+#include "checkpoint.h"
 #include "cpu.h"
 #include "function.h"
 #include "html_data.h"
 #include "internal.h"
 #include "stats.h"
+#include "telemetry.h"
+#include "trace.h"
 
 #ifndef _WIN32
   #if HAVE_PTHREAD_SETAFFINITY_NP
@@ -70,10 +74,26 @@
   #include <sys/prctl.h>
 #endif
 
+#if HAVE_FORK
+  #include <signal.h>
+  #include <sys/types.h>
+  #include <sys/wait.h>
+  #include <unistd.h>
+#endif
+
 /* Internal state */
 static CheckasmConfig cfg;
 static CheckasmStats  stats; /* temporary buffer for function measurements */
 
+/* Successive measurements made by a single checkasm_bench() call */
+typedef enum BenchPhase {
+    BENCH_THROUGHPUT,
+    BENCH_THREADS, /* under contention, see start_bench_workers() */
+    BENCH_LATENCY, /* serially dependent calls, see checkasm_bench_serial() */
+    BENCH_TAIL,    /* single calls with warm caches, see cfg.bench_quantiles */
+    BENCH_COLD,    /* single calls with cold caches, see cfg.cache_state */
+} BenchPhase;
+
 /* Current function/test state, reset after each test run */
 static struct {
     CheckasmFuncTree tree;
@@ -92,6 +112,25 @@ static struct {
     CheckasmFuncVersion *func_ver;
     char                *func_variant;
     uint64_t             cycles;
+    CheckasmCounters     counters;
+    CheckasmRejects      rejects; /* checkasm_bench_trim() */
+    BenchPhase           bench_phase;
+    int                  bench_latency; /* checkasm_bench_latency() */
+    int                  cold_calls;
+    int                  tail_eligible; /* slow enough for single calls */
+    int                  resumed;       /* results restored from a checkpoint */
+    CheckasmHistogram    quantiles;     /* single calls in BENCH_TAIL */
+    uint64_t             work_bytes, work_elems; /* checkasm_bench_set_work() */
+    uint64_t             work_ops;               /* checkasm_bench_set_ops() */
+
+    /* Sampled around the current measurement, with cfg.telemetry */
+    CheckasmTelemetrySample telemetry_start, telemetry_end;
+    int                     telemetry_reruns; /* due to clock transitions */
+
+    /* Batches of the reference timed in lockstep, with cfg.bench_paired */
+    CheckasmSample paired_ref; /* pending until the matching bench_update() */
+    CheckasmPaired paired;
+    int            paired_side_ref; /* timing the reference side right now */
 
     /* Overall stats for this test run */
     int    num_funcs;                   /* known functions */
@@ -103,6 +142,8 @@ static struct {
     double var_sum, var_max;
 } current;
 
+#define MAX_BENCH_THREADS 256
+
 /* Global state for the entire checkasm_run() call */
 static struct {
     /* Miscellaneous global state (cosmetic) */
@@ -112,11 +153,42 @@ static struct {
 
     /* Timing code measurements (aggregated over multiple trials) */
     CheckasmMeasurement nop_cycles;
+    CheckasmMeasurement nop_cycles_single; /* for single call benchmarks */
+    CheckasmMeasurement nop_cycles_serial; /* for latency benchmarks */
+    int                 latency_benched;   /* since the last nop_cycles_serial */
     CheckasmMeasurement perf_scale;
+    CheckasmRoofline    roofline;  /* measured once, with cfg.roofline */
+    int                 telemetry; /* cfg.telemetry, if any sysfs file was found */
+    CheckasmEnvironment env;       /* checked and hardened with cfg.stable_env */
 
     /* Runtime constants */
     uint64_t target_cycles;
     int      skip_tests;
+
+    /* Loaded from cfg.compare_baseline */
+    CheckasmBaseline baseline;
+
+    /* Opened from cfg.checkpoint_file */
+    CheckasmCheckpoint checkpoint;
+
+    /* Set inside forked child processes (see run_parallel()) */
+    FILE *child_results;
+    int   isolated;
+
+    /* Progress of run_test(), for resuming after a crash */
+    int         next_cpu;
+    CheckasmCpu next_cpu_flags;
+
+#if HAVE_FORK
+    /* Contention benchmarks with cfg.bench_threads (see start_bench_workers()) */
+    int   bench_cpus[MAX_BENCH_THREADS];
+    int   nb_bench_cpus; /* 0 if the CPU affinity can't be controlled */
+    pid_t    bench_workers[MAX_BENCH_THREADS];
+    int      nb_bench_workers;
+    int      bench_results; /* pipe for the totals of each worker */
+    int      bench_worker;  /* set inside worker processes */
+    uint64_t worker_cycles, worker_iters; /* totals so far, inside a worker */
+#endif
 } state;
 
 CheckasmCpu checkasm_get_cpu_flags(void)
@@ -146,6 +218,20 @@ static double relative_error(double lvar)
     return sqrt(exp(lvar) - 1.0);
 }
 
+static const char *const cache_state_names[] = {
+    [CHECKASM_CACHE_HOT]  = "l1",
+    [CHECKASM_CACHE_L2]   = "l2",
+    [CHECKASM_CACHE_LLC]  = "llc",
+    [CHECKASM_CACHE_DRAM] = "dram",
+};
+
+static const char *const outlier_names[] = {
+    [CHECKASM_OUTLIERS_RATIO] = "ratio",
+    [CHECKASM_OUTLIERS_NONE]  = "none",
+    [CHECKASM_OUTLIERS_MAD]   = "mad",
+    [CHECKASM_OUTLIERS_TRIM]  = "trim",
+};
+
 static inline char separator(CheckasmFormat format)
 {
     switch (format) {
@@ -182,6 +268,10 @@ static void json_measurement(CheckasmJson *json, const char *key, const char *un
         checkasm_json_push(json, key, '{');
     json_var(json, NULL, unit, result);
     checkasm_json(json, "numMeasurements", "%d", measurement.nb_measurements);
+    const int nb_iters = measurement.nb_iters
+                       + (measurement.nb_measurements > measurement.iter_start);
+    if (nb_iters > 1)
+        checkasm_json(json, "numIterations", "%d", nb_iters);
 
     if (measurement.stats.nb_samples) {
         json_var(json, "regressionSlope", unit,
@@ -199,6 +289,31 @@ static void json_measurement(CheckasmJson *json, const char *key, const char *un
         checkasm_json_pop(json, '}');
 }
 
+/* Per-call averages of the additional performance counters */
+static void json_counters(CheckasmJson *json, const CheckasmCounters counters)
+{
+    const CheckasmPerfCounters *const pc = &checkasm_perf_counters;
+    double cycles = 0.0, instructions = 0.0, ref_cycles = 0.0;
+
+    checkasm_json_push(json, "counters", '{');
+    for (int i = 0; i < pc->nb_counters; i++) {
+        const double per_call = (double) counters.values[i] / counters.iters;
+        checkasm_json(json, pc->names[i], "%g", per_call);
+        if (!strcmp(pc->names[i], "cycles"))
+            cycles = per_call;
+        else if (!strcmp(pc->names[i], "instructions"))
+            instructions = per_call;
+        else if (!strcmp(pc->names[i], "refCycles"))
+            ref_cycles = per_call;
+    }
+    checkasm_json_pop(json, '}');
+
+    if (cycles > 0.0 && instructions > 0.0)
+        checkasm_json(json, "instructionsPerCycle", "%g", instructions / cycles);
+    if (cycles > 0.0 && ref_cycles > 0.0)
+        checkasm_json(json, "clockRatio", "%g", cycles / ref_cycles);
+}
+
 static void cpu_info_json(void *priv, const char *fmt, ...)
 {
     CheckasmJson *json = priv;
@@ -226,10 +341,182 @@ static void cpu_mask_json(CheckasmJson *json, const CheckasmConfig cfg,
     checkasm_json_pop(json, ']');
 }
 
+/* Busy fraction of an SMT sibling above which it disturbs benchmarks */
+#define SIBLING_LOAD_MAX 0.05
+
+/* Conditions found by cfg.stable_env that hurt reproducibility */
+static int env_issues(const char *issues[8])
+{
+    const CheckasmEnvironment *const env = &state.env;
+    int                              nb  = 0;
+
+    if (!cfg.cpu_affinity_set)
+        issues[nb++] = "not pinned to a CPU (see --affinity)";
+    if (env->governor[0] && strcmp(env->governor, "performance"))
+        issues[nb++] = "CPU frequency governor is not 'performance'";
+    if (env->turbo > 0)
+        issues[nb++] = "turbo boost is enabled";
+    if (!env->isolated)
+        issues[nb++] = "CPU is not isolated (isolcpus)";
+    if (env->sibling_load > SIBLING_LOAD_MAX)
+        issues[nb++] = "SMT sibling is busy";
+    if (!env->locked)
+        issues[nb++] = "memory could not be locked (RLIMIT_MEMLOCK too low)";
+    if (env->nice >= 0)
+        issues[nb++] = "priority could not be raised (RLIMIT_NICE)";
+    return nb;
+}
+
+static void json_environment(CheckasmJson *json)
+{
+    const CheckasmEnvironment *const env = &state.env;
+    const char                      *issues[8];
+    const int                        nb_issues = env_issues(issues);
+
+    checkasm_json_push(json, "stableEnv", '{');
+    checkasm_json(json, "cpu", "%d", env->cpu);
+    if (env->governor[0])
+        checkasm_json_str(json, "governor", env->governor);
+    if (env->turbo >= 0)
+        checkasm_json(json, "turboBoost", env->turbo ? "true" : "false");
+    if (env->isolated >= 0)
+        checkasm_json(json, "isolated", env->isolated ? "true" : "false");
+    if (env->nohz_full >= 0)
+        checkasm_json(json, "nohzFull", env->nohz_full ? "true" : "false");
+    checkasm_json_push(json, "smtSiblings", '[');
+    for (int i = 0; i < env->nb_siblings; i++)
+        checkasm_json(json, NULL, "%d", env->siblings[i]);
+    checkasm_json_pop(json, ']');
+    if (!isnan(env->sibling_load))
+        checkasm_json(json, "siblingLoad", "%g", env->sibling_load);
+    checkasm_json(json, "memoryLocked", env->locked ? "true" : "false");
+    if (env->memlock_limit >= 0)
+        checkasm_json(json, "memlockLimit", "%" PRId64, env->memlock_limit);
+    checkasm_json(json, "nice", "%d", env->nice);
+    checkasm_json_push(json, "issues", '[');
+    for (int i = 0; i < nb_issues; i++)
+        checkasm_json_str(json, NULL, issues[i]);
+    checkasm_json_pop(json, ']');
+    checkasm_json_pop(json, '}');
+}
+
+/* Global configuration and calibration data, shared by all JSON based formats */
+static void json_run_info(CheckasmJson *json)
+{
+    if (cfg.bench)
+        checkasm_json(json, "targetCycles", "%" PRIu64, state.target_cycles);
+    checkasm_json_push(json, "config", '{');
+    if (cfg.test_pattern)
+        checkasm_json_str(json, "testPattern", cfg.test_pattern);
+    if (cfg.function_pattern)
+        checkasm_json_str(json, "functionPattern", cfg.function_pattern);
+    checkasm_json(json, "benchUsec", "%u", cfg.bench_usec);
+    if (cfg.bench_precision)
+        checkasm_json(json, "benchPrecision", "%g", cfg.bench_precision);
+    if (cfg.cache_state != CHECKASM_CACHE_HOT)
+        checkasm_json_str(json, "cacheState", cache_state_names[cfg.cache_state]);
+    if (cfg.bench_latency)
+        checkasm_json(json, "benchLatency", "true");
+    if (cfg.bench_paired)
+        checkasm_json(json, "benchPaired", "true");
+    if (cfg.bench_threads > 1)
+        checkasm_json(json, "benchThreads", "%u", cfg.bench_threads);
+    if (cfg.bench_quantiles)
+        checkasm_json(json, "benchQuantiles", "true");
+    if (cfg.roofline)
+        checkasm_json(json, "roofline", "true");
+    if (cfg.telemetry)
+        checkasm_json_str(json, "telemetry", cfg.telemetry_root);
+    if (cfg.stable_env && cfg.bench)
+        json_environment(json);
+    checkasm_json_str(json, "outliers", outlier_names[cfg.outliers]);
+    if (cfg.trace_file)
+        checkasm_json_str(json, "traceFile", cfg.trace_file);
+    if (cfg.checkpoint_file)
+        checkasm_json_str(json, "checkpointFile", cfg.checkpoint_file);
+    if (cfg.resume)
+        checkasm_json(json, "resume", "true");
+    checkasm_json(json, "seed", "%u", cfg.seed);
+    checkasm_json(json, "repeat", "%u", cfg.repeat);
+    if (cfg.merge_repeats)
+        checkasm_json(json, "mergeRepeats", "true");
+    if (cfg.exact_init)
+        checkasm_json(json, "exactInit", "true");
+    if (cfg.cpu_affinity_set)
+        checkasm_json(json, "cpuAffinity", "%u", cfg.cpu_affinity);
+    if (checkasm_perf_counters.nb_counters) {
+        checkasm_json_push(json, "perfCounters", '[');
+        for (int i = 0; i < checkasm_perf_counters.nb_counters; i++)
+            checkasm_json_str(json, NULL, checkasm_perf_counters.names[i]);
+        checkasm_json_pop(json, ']');
+    }
+    checkasm_json_pop(json, '}'); /* close config */
+    checkasm_json_push(json, "cpuInfo", '[');
+    checkasm_cpu_info(cpu_info_json, json, &cfg);
+    checkasm_json_pop(json, ']');
+    checkasm_json_push(json, "cpuFlags", '{');
+    for (const CheckasmCpuInfo *info = cfg.cpu_flags; info->flag; info++) {
+        const int available = (cfg.cpu & info->flag) == info->flag;
+        checkasm_json_push(json, info->suffix, '{');
+        checkasm_json_str(json, "name", info->name);
+        checkasm_json(json, "available", available ? "true" : "false");
+        cpu_mask_json(json, cfg, info->mask);
+        checkasm_json_pop(json, '}');
+    }
+    checkasm_json_pop(json, '}'); /* close cpuFlags */
+    checkasm_json_push(json, "tests", '[');
+    for (const CheckasmTest *test = cfg.tests; test->func; test++)
+        checkasm_json_str(json, NULL, test->name);
+    checkasm_json_pop(json, ']'); /* close tests */
+    if (!cfg.bench)
+        return;
+
+    const CheckasmVar nop_cycles = checkasm_measurement_result(state.nop_cycles);
+    const CheckasmVar perf_scale = checkasm_measurement_result(state.perf_scale);
+    const CheckasmVar nop_time   = checkasm_var_mul(nop_cycles, perf_scale);
+    char              perf_scale_unit[32];
+    snprintf(perf_scale_unit, sizeof(perf_scale_unit), "nsec/%s", checkasm_perf.unit);
+    json_measurement(json, "nopCycles", checkasm_perf.unit, state.nop_cycles);
+    if (state.nop_cycles_single.nb_measurements) {
+        json_measurement(json, "nopCyclesSingle", checkasm_perf.unit,
+                         state.nop_cycles_single);
+    }
+    if (state.nop_cycles_serial.nb_measurements) {
+        json_measurement(json, "nopCyclesSerial", checkasm_perf.unit,
+                         state.nop_cycles_serial);
+    }
+    json_measurement(json, "timerScale", perf_scale_unit, state.perf_scale);
+    json_var(json, "nopTime", checkasm_perf.unit, nop_time);
+
+    if (cfg.roofline) {
+        const CheckasmRoofline *const roof = &state.roofline;
+        checkasm_json_push(json, "roofline", '{');
+        checkasm_json(json, "peakOpsPerSecond", "%g", 1e9 * roof->peak_ops);
+        checkasm_json_str(json, "peakOpsIsa", roof->peak_isa);
+        checkasm_json_push(json, "levels", '[');
+        for (int level = CHECKASM_CACHE_HOT; level <= CHECKASM_CACHE_DRAM; level++) {
+            checkasm_json_push(json, NULL, '{');
+            checkasm_json_str(json, "name", cache_state_names[level]);
+            if (level < CHECKASM_CACHE_DRAM)
+                checkasm_json(json, "size", "%" PRIu64, (uint64_t) roof->size[level]);
+            checkasm_json(json, "bytesPerSecond", "%g", 1e9 * roof->bandwidth[level]);
+            checkasm_json_pop(json, '}');
+        }
+        checkasm_json_pop(json, ']'); /* close levels */
+        checkasm_json_pop(json, '}'); /* close roofline */
+    }
+}
+
 struct IterState {
-    const char  *test;
-    const char  *report;
-    CheckasmJson json;
+    const char     *test;
+    const char     *report;
+    CheckasmJson    json;
+    int             has_work;    /* any function called checkasm_bench_set_work() */
+    int             has_ops;     /* any function called checkasm_bench_set_ops() */
+    int             has_latency; /* any function was benchmarked for latency */
+    int             has_threads; /* any function was benchmarked under contention */
+    int             has_telemetry; /* any function has clock or temperature data */
+    CheckasmRejects rejects;     /* total over all functions */
 };
 
 static void print_bench_header(struct IterState *const iter)
@@ -240,12 +527,34 @@ static void print_bench_header(struct IterState *const iter)
     CheckasmJson *const json       = &iter->json;
 
     switch (cfg.format) {
+    case CHECKASM_FORMAT_NDJSON: break; /* streamed by checkasm_report() */
     case CHECKASM_FORMAT_TSV:
     case CHECKASM_FORMAT_CSV:
         if (cfg.verbose) {
             const char sep = separator(cfg.format);
-            printf("name%csuffix%c%ss%cstddev%cnanoseconds\n", sep, sep,
+            printf("name%csuffix%c%ss%cstddev%cnanoseconds", sep, sep,
                    checkasm_perf.unit, sep, sep);
+            if (iter->has_threads) {
+                printf("%cthreaded_%ss%cscaling_efficiency%caggregate_throughput", sep,
+                       checkasm_perf.unit, sep, sep);
+            }
+            if (iter->has_latency)
+                printf("%clatency_%ss", sep, checkasm_perf.unit);
+            if (iter->has_work) {
+                printf("%c%ss_per_element%celements_per_second%cgb_per_second", sep,
+                       checkasm_perf.unit, sep, sep);
+            }
+            if (iter->has_ops)
+                printf("%cgops_per_second", sep);
+            if (iter->has_work && cfg.roofline) {
+                printf("%cmemory_level%cbandwidth_fraction%ccompute_fraction", sep, sep,
+                       sep);
+            }
+            if (iter->has_telemetry) {
+                printf("%cclock_ratio%cclock_drift%cmax_temperature%cunstable", sep, sep,
+                       sep, sep);
+            }
+            printf("\n");
             printf("nop%c%c%.4f%c%.5f%c%.4f\n", sep, sep, checkasm_mode(nop_cycles), sep,
                    checkasm_stddev(nop_cycles), sep, checkasm_mode(nop_time));
         }
@@ -271,41 +580,8 @@ static void print_bench_header(struct IterState *const iter)
         checkasm_json_str(json, "checkasmVersion", CHECKASM_VERSION);
         checkasm_json(json, "numChecked", "%d", current.num_checked);
         checkasm_json(json, "numFailed", "%d", current.num_failed);
-        checkasm_json(json, "targetCycles", "%" PRIu64, state.target_cycles);
         checkasm_json(json, "numBenchmarks", "%d", current.num_benched);
-        checkasm_json_push(json, "config", '{');
-        if (cfg.test_pattern)
-            checkasm_json_str(json, "testPattern", cfg.test_pattern);
-        if (cfg.function_pattern)
-            checkasm_json_str(json, "functionPattern", cfg.function_pattern);
-        checkasm_json(json, "benchUsec", "%u", cfg.bench_usec);
-        checkasm_json(json, "seed", "%u", cfg.seed);
-        checkasm_json(json, "repeat", "%u", cfg.repeat);
-        if (cfg.cpu_affinity_set)
-            checkasm_json(json, "cpuAffinity", "%u", cfg.cpu_affinity);
-        checkasm_json_pop(json, '}'); /* close config */
-        checkasm_json_push(json, "cpuInfo", '[');
-        checkasm_cpu_info(cpu_info_json, json, &cfg);
-        checkasm_json_pop(json, ']');
-        checkasm_json_push(json, "cpuFlags", '{');
-        for (const CheckasmCpuInfo *info = cfg.cpu_flags; info->flag; info++) {
-            const int available = (cfg.cpu & info->flag) == info->flag;
-            checkasm_json_push(json, info->suffix, '{');
-            checkasm_json_str(json, "name", info->name);
-            checkasm_json(json, "available", available ? "true" : "false");
-            cpu_mask_json(json, cfg, info->mask);
-            checkasm_json_pop(json, '}');
-        }
-        checkasm_json_pop(json, '}'); /* close cpuFlags */
-        checkasm_json_push(json, "tests", '[');
-        for (const CheckasmTest *test = cfg.tests; test->func; test++)
-            checkasm_json_str(json, NULL, test->name);
-        checkasm_json_pop(json, ']'); /* close tests */
-        char perf_scale_unit[32];
-        snprintf(perf_scale_unit, sizeof(perf_scale_unit), "nsec/%s", checkasm_perf.unit);
-        json_measurement(json, "nopCycles", checkasm_perf.unit, state.nop_cycles);
-        json_measurement(json, "timerScale", perf_scale_unit, state.perf_scale);
-        json_var(json, "nopTime", checkasm_perf.unit, nop_time);
+        json_run_info(json);
         checkasm_json(json, "numFunctions", "%d", current.num_funcs);
         checkasm_json_push(json, "functions", '{');
         break;
@@ -317,6 +593,18 @@ static void print_bench_header(struct IterState *const iter)
             checkasm_fprintf(stdout, COLOR_GREEN, " +/- stddev %*s", 26,
                              "time (nanoseconds)");
         }
+        if (iter->has_threads) {
+            char threads[32];
+            snprintf(threads, sizeof(threads), "%u threads", cfg.bench_threads);
+            checkasm_fprintf(stdout, COLOR_GREEN, " %16s %6s", threads, "total");
+        }
+        if (iter->has_latency)
+            checkasm_fprintf(stdout, COLOR_GREEN, " %10s", "latency");
+        if (cfg.cache_state != CHECKASM_CACHE_HOT) {
+            char cold[16];
+            snprintf(cold, sizeof(cold), "cold (%s)", cache_state_names[cfg.cache_state]);
+            checkasm_fprintf(stdout, COLOR_GREEN, " %12s", cold);
+        }
         checkasm_fprintf(stdout, COLOR_GREEN, " (vs ref)\n");
         if (cfg.verbose) {
             printf("  nop:%*.1f +/- %-7.1f %11.1f ns +/- %-6.1f\n",
@@ -336,19 +624,29 @@ static void print_bench_footer(struct IterState *const iter)
 
     switch (cfg.format) {
     case CHECKASM_FORMAT_TSV:
-    case CHECKASM_FORMAT_CSV: break;
+    case CHECKASM_FORMAT_CSV:
+    case CHECKASM_FORMAT_NDJSON: break;
     case CHECKASM_FORMAT_PRETTY:
         if (cfg.verbose) {
             printf(" - average timing error: %.3f%% across %d benchmarks "
                    "(maximum %.3f%%)\n",
                    100.0 * err_rel, current.num_benched, 100.0 * err_max);
         }
+        if (cfg.verbose && iter->rejects.batches) {
+            printf(" - rejected outliers: %.3f%% of %" PRIu64 " batches (%s)\n",
+                   100.0 * iter->rejects.rejected / iter->rejects.batches,
+                   iter->rejects.batches, outlier_names[cfg.outliers]);
+        }
         break;
     case CHECKASM_FORMAT_HTML:
     case CHECKASM_FORMAT_JSON:
         checkasm_json_pop(json, '}'); /* close functions */
         checkasm_json(json, "averageError", "%g", err_rel);
         checkasm_json(json, "maximumError", "%g", err_max);
+        if (iter->rejects.batches) {
+            checkasm_json(json, "totalBatches", "%" PRIu64, iter->rejects.batches);
+            checkasm_json(json, "rejectedBatches", "%" PRIu64, iter->rejects.rejected);
+        }
         checkasm_json_pop(json, '}'); /* close root */
 
         if (cfg.format == CHECKASM_FORMAT_HTML) {
@@ -364,6 +662,324 @@ static void print_bench_footer(struct IterState *const iter)
     }
 }
 
+/* Measured cycles, minus the overhead of the timing code */
+static CheckasmVar adjusted_cycles(const CheckasmFuncVersion *const v)
+{
+    const CheckasmVar raw        = checkasm_measurement_result(v->cycles);
+    const CheckasmVar nop_cycles = checkasm_measurement_result(state.nop_cycles);
+    return checkasm_var_sub(raw, nop_cycles);
+}
+
+/* Speedup over the reference, from the paired batches if there are any */
+static CheckasmVar speedup(const CheckasmFuncVersion *const ref,
+                           const CheckasmFuncVersion *const v)
+{
+    if (v->paired.nb)
+        return checkasm_paired_result(v->paired);
+    return checkasm_var_div(adjusted_cycles(ref), adjusted_cycles(v));
+}
+
+/* Geometric mean amount of work per call, or 0 if it's not known for all
+ * measurements of this version */
+static double work_per_call(const CheckasmFuncVersion *const v, const double lsum,
+                            const int nb)
+{
+    return nb && nb == v->cycles.nb_measurements ? exp(lsum / nb) : 0.0;
+}
+
+/* Smallest memory level holding all bytes accessed per call, which bounds the
+ * bandwidth available to repeated calls on the same data */
+static CheckasmCacheState roofline_level(const double bytes)
+{
+    int level = CHECKASM_CACHE_HOT;
+    while (level < CHECKASM_CACHE_DRAM && bytes > (double) state.roofline.size[level])
+        level++;
+    return (CheckasmCacheState) level;
+}
+
+static int has_work(const CheckasmFuncVersion *const v)
+{
+    return v->work.nb_bytes || v->work.nb_elems || v->work.nb_ops;
+}
+
+static int has_ops(const CheckasmFuncVersion *const v)
+{
+    return v->work.nb_ops;
+}
+
+static int has_latency(const CheckasmFuncVersion *const v)
+{
+    return v->latency.nb_measurements;
+}
+
+static int has_threads(const CheckasmFuncVersion *const v)
+{
+    return v->threaded_cycles.nb_measurements;
+}
+
+static int has_telemetry(const CheckasmFuncVersion *const v)
+{
+    return v->telemetry.nb_ratios || v->telemetry.nb_temps;
+}
+
+/* Geometric mean clock ratio over all measurements, or 0 if unknown */
+static double clock_ratio(const CheckasmTelemetry *const t)
+{
+    return t->nb_ratios ? exp(t->lratio / t->nb_ratios) : 0.0;
+}
+
+/* Spread of the clock ratio seen across all measurements, relative to its mean */
+static double clock_drift(const CheckasmTelemetry *const t)
+{
+    return t->nb_ratios ? (t->ratio_max - t->ratio_min) / clock_ratio(t) : 0.0;
+}
+
+/* Check if any function version satisfies the given predicate */
+static int any_version(const CheckasmFunc *const f,
+                       int (*const pred)(const CheckasmFuncVersion *))
+{
+    if (!f)
+        return 0;
+
+    for (const CheckasmFuncVersion *v = &f->versions; v; v = v->next) {
+        if (pred(v))
+            return 1;
+    }
+
+    return any_version(f->child[0], pred) || any_version(f->child[1], pred);
+}
+
+/* Sum up the outliers rejected across all function versions */
+static void sum_rejects(const CheckasmFunc *const f, CheckasmRejects *const out)
+{
+    if (!f)
+        return;
+
+    sum_rejects(f->child[0], out);
+    for (const CheckasmFuncVersion *v = &f->versions; v; v = v->next)
+        checkasm_rejects_add(out, v->rejects);
+    sum_rejects(f->child[1], out);
+}
+
+/* Same as adjusted_cycles(), for the measurements under contention */
+static CheckasmVar adjusted_threaded_cycles(const CheckasmFuncVersion *const v)
+{
+    const CheckasmVar raw        = checkasm_measurement_result(v->threaded_cycles);
+    const CheckasmVar nop_cycles = checkasm_measurement_result(state.nop_cycles);
+    return checkasm_var_sub(raw, nop_cycles);
+}
+
+/* Same as adjusted_threaded_cycles(), for the worker processes */
+static CheckasmVar adjusted_worker_cycles(const CheckasmFuncVersion *const v)
+{
+    const CheckasmVar raw        = checkasm_measurement_result(v->worker_cycles);
+    const CheckasmVar nop_cycles = checkasm_measurement_result(state.nop_cycles);
+    return checkasm_var_sub(raw, nop_cycles);
+}
+
+/* Throughput under contention summed over all threads, relative to a single
+ * thread running alone; cfg.bench_threads means perfect scaling */
+static CheckasmVar aggregate_throughput(const CheckasmFuncVersion *const v)
+{
+    const CheckasmVar cycles = adjusted_cycles(v);
+    const CheckasmVar own    = checkasm_var_div(cycles, adjusted_threaded_cycles(v));
+    if (!v->worker_cycles.nb_measurements) /* assume the workers did the same */
+        return checkasm_var_scale(own, cfg.bench_threads);
+
+    const CheckasmVar workers = checkasm_var_div(cycles, adjusted_worker_cycles(v));
+    return checkasm_var_add(own, checkasm_var_scale(workers, cfg.bench_threads - 1));
+}
+
+/* Same as adjusted_cycles(), for the serially dependent calls, which are timed
+ * with a different loop */
+static CheckasmVar adjusted_latency(const CheckasmFuncVersion *const v)
+{
+    const CheckasmVar raw = checkasm_measurement_result(v->latency);
+    const CheckasmVar nop = checkasm_measurement_result(
+        state.nop_cycles_serial.nb_measurements ? state.nop_cycles_serial
+                                                : state.nop_cycles);
+    return checkasm_var_sub(raw, nop);
+}
+
+/* Same as adjusted_cycles(), for the single call cold cache measurements */
+static CheckasmVar adjusted_cold_cycles(const CheckasmFuncVersion *const v)
+{
+    const CheckasmVar raw = checkasm_measurement_result(v->cold_cycles);
+    if (!state.nop_cycles_single.nb_measurements)
+        return raw;
+    const CheckasmVar nop = checkasm_measurement_result(state.nop_cycles_single);
+    return checkasm_var_sub(raw, nop);
+}
+
+/* Timer overhead of a single call, subtracted from the latency distribution */
+static double single_call_overhead(void)
+{
+    if (!state.nop_cycles_single.nb_measurements)
+        return 0.0;
+    return checkasm_mode(checkasm_measurement_result(state.nop_cycles_single));
+}
+
+static void json_telemetry(CheckasmJson *json, const CheckasmTelemetry *const t)
+{
+    checkasm_json_push(json, "telemetry", '{');
+    if (t->nb_ratios) {
+        checkasm_json(json, "clockRatio", "%g", clock_ratio(t));
+        checkasm_json(json, "clockRatioMin", "%g", t->ratio_min);
+        checkasm_json(json, "clockRatioMax", "%g", t->ratio_max);
+        checkasm_json(json, "clockDrift", "%g", clock_drift(t));
+    }
+    if (t->nb_temps)
+        checkasm_json(json, "maxTemperature", "%g", t->temp_max);
+    checkasm_json(json, "reruns", "%d", t->reruns);
+    checkasm_json(json, "unstableMeasurements", "%d", t->unstable);
+    checkasm_json_pop(json, '}');
+}
+
+static void json_quantiles(CheckasmJson *json, const CheckasmHistogram *const hist)
+{
+    static const struct {
+        const char *name;
+        double      q;
+    } quantiles[] = {
+        { "p50",  0.50  },
+        { "p90",  0.90  },
+        { "p99",  0.99  },
+        { "p999", 0.999 },
+    };
+
+    const double overhead = single_call_overhead();
+    checkasm_json_push(json, "quantiles", '{');
+    checkasm_json_str(json, "unit", checkasm_perf.unit);
+    checkasm_json(json, "numSamples", "%" PRIu64, hist->count);
+    checkasm_json(json, "overhead", "%g", overhead);
+    for (size_t i = 0; i < ARRAY_SIZE(quantiles); i++) {
+        const double value = checkasm_histogram_quantile(hist, quantiles[i].q);
+        checkasm_json(json, quantiles[i].name, "%g", fmax(value - overhead, 0.0));
+    }
+    checkasm_json(json, "max", "%g", fmax(hist->max - overhead, 0.0));
+
+    /* Raw (unadjusted) histogram buckets, omitting empty ones */
+    checkasm_json_push(json, "rawHistogram", '[');
+    for (int i = 0; i < CHECKASM_HIST_BUCKETS; i++) {
+        if (!hist->buckets[i])
+            continue;
+        checkasm_json(json, NULL,
+                      "{ \"cycles\": %" PRIu64 ", \"width\": %" PRIu64
+                      ", \"count\": %" PRIu32 " }",
+                      checkasm_histogram_bucket_start(i),
+                      checkasm_histogram_bucket_width(i), hist->buckets[i]);
+    }
+    checkasm_json_pop(json, ']');
+    checkasm_json_pop(json, '}');
+}
+
+/* Results of a single function version, shared by all JSON based formats */
+static void json_version(CheckasmJson *json, const CheckasmFunc *const f,
+                         const CheckasmFuncVersion *const v)
+{
+    const CheckasmFuncVersion *ref        = &f->versions;
+    const CheckasmVar          perf_scale = checkasm_measurement_result(state.perf_scale);
+    const CheckasmVar          raw        = checkasm_measurement_result(v->cycles);
+    const CheckasmVar          cycles     = adjusted_cycles(v);
+    const CheckasmVar          raw_time   = checkasm_var_mul(raw, perf_scale);
+    const CheckasmVar          time       = checkasm_var_mul(cycles, perf_scale);
+    const CheckasmVar          giga       = checkasm_var_const(1e9);
+
+    json_measurement(json, "rawCycles", checkasm_perf.unit, v->cycles);
+    json_var(json, "rawTime", "nsec", raw_time);
+    json_var(json, "adjustedCycles", checkasm_perf.unit, cycles);
+    json_var(json, "adjustedTime", "nsec", time);
+    if (v != ref && ref->cycles.nb_measurements) {
+        json_var(json, "ratio", NULL, speedup(ref, v));
+        if (v->paired.nb) {
+            json_var(json, "unpairedRatio", NULL,
+                     checkasm_var_div(adjusted_cycles(ref), cycles));
+            checkasm_json(json, "pairedBatches", "%d", v->paired.nb);
+        }
+    }
+    if (v->counters.iters)
+        json_counters(json, v->counters);
+    if (v->rejects.batches) {
+        checkasm_json(json, "totalBatches", "%" PRIu64, v->rejects.batches);
+        checkasm_json(json, "rejectedBatches", "%" PRIu64, v->rejects.rejected);
+        checkasm_json(json, "rejectedFraction", "%g",
+                      (double) v->rejects.rejected / v->rejects.batches);
+    }
+    if (has_telemetry(v))
+        json_telemetry(json, &v->telemetry);
+
+    const CheckasmWork w     = v->work;
+    const double       elems = work_per_call(v, w.lelems, w.nb_elems);
+    const double       bytes = work_per_call(v, w.lbytes, w.nb_bytes);
+    const double       ops   = work_per_call(v, w.lops, w.nb_ops);
+    const CheckasmVar  byte_rate = checkasm_var_div(checkasm_var_const(bytes), time);
+    const CheckasmVar  op_rate   = checkasm_var_div(checkasm_var_const(ops), time);
+    if (elems) {
+        const CheckasmVar var_elems = checkasm_var_const(elems);
+        const CheckasmVar elem_rate = checkasm_var_div(var_elems, time);
+        checkasm_json(json, "elementsPerCall", "%g", elems);
+        json_var(json, "cyclesPerElement", checkasm_perf.unit,
+                 checkasm_var_div(cycles, var_elems));
+        json_var(json, "elementsPerSecond", "1/sec", checkasm_var_mul(elem_rate, giga));
+    }
+    if (bytes) {
+        checkasm_json(json, "bytesPerCall", "%g", bytes);
+        json_var(json, "bytesPerSecond", "1/sec", checkasm_var_mul(byte_rate, giga));
+    }
+    if (ops) {
+        checkasm_json(json, "opsPerCall", "%g", ops);
+        json_var(json, "opsPerSecond", "1/sec", checkasm_var_mul(op_rate, giga));
+    }
+    if (cfg.roofline && (bytes || ops)) {
+        const CheckasmRoofline *const roof = &state.roofline;
+        checkasm_json_push(json, "roofline", '{');
+        if (bytes) {
+            const CheckasmCacheState level = roofline_level(bytes);
+            const CheckasmVar        bw    = checkasm_var_const(roof->bandwidth[level]);
+            checkasm_json_str(json, "memoryLevel", cache_state_names[level]);
+            json_var(json, "bandwidthFraction", NULL, checkasm_var_div(byte_rate, bw));
+        }
+        if (ops) {
+            const CheckasmVar peak = checkasm_var_const(roof->peak_ops);
+            json_var(json, "computeFraction", NULL, checkasm_var_div(op_rate, peak));
+        }
+        checkasm_json_pop(json, '}');
+    }
+
+    if (v->threaded_cycles.nb_measurements) {
+        const CheckasmVar total = aggregate_throughput(v);
+        json_measurement(json, "rawThreadedCycles", checkasm_perf.unit,
+                         v->threaded_cycles);
+        json_var(json, "adjustedThreadedCycles", checkasm_perf.unit,
+                 adjusted_threaded_cycles(v));
+        if (v->worker_cycles.nb_measurements) {
+            json_measurement(json, "rawWorkerCycles", checkasm_perf.unit,
+                             v->worker_cycles);
+            json_var(json, "adjustedWorkerCycles", checkasm_perf.unit,
+                     adjusted_worker_cycles(v));
+        }
+        json_var(json, "aggregateThroughput", NULL, total);
+        json_var(json, "scalingEfficiency", NULL,
+                 checkasm_var_scale(total, 1.0 / cfg.bench_threads));
+    }
+    if (v->latency.nb_measurements) {
+        json_measurement(json, "rawLatency", checkasm_perf.unit, v->latency);
+        json_var(json, "adjustedLatency", checkasm_perf.unit, adjusted_latency(v));
+    }
+    if (v->cold_cycles.nb_measurements) {
+        json_measurement(json, "rawColdCycles", checkasm_perf.unit, v->cold_cycles);
+        json_var(json, "adjustedColdCycles", checkasm_perf.unit,
+                 adjusted_cold_cycles(v));
+    }
+    if (v->quantiles)
+        json_quantiles(json, v->quantiles);
+
+    const CheckasmBaselineEntry *const base
+        = checkasm_baseline_find(&state.baseline, f->name, ver_suffix(v));
+    if (base)
+        json_var(json, "baselineRatio", NULL, checkasm_var_div(cycles, base->cycles));
+}
+
 static void print_bench_iter(const CheckasmFunc *const f, struct IterState *const iter)
 {
     CheckasmJson *const json = &iter->json;
@@ -375,7 +991,6 @@ static void print_bench_iter(const CheckasmFunc *const f, struct IterState *cons
 
     const CheckasmFuncVersion *ref        = &f->versions;
     const CheckasmFuncVersion *v          = ref;
-    const CheckasmVar          nop_cycles = checkasm_measurement_result(state.nop_cycles);
     const CheckasmVar          perf_scale = checkasm_measurement_result(state.perf_scale);
 
     /* Defer pushing the function header until we know that we have at least one
@@ -384,15 +999,42 @@ static void print_bench_iter(const CheckasmFunc *const f, struct IterState *cons
 
     do {
         if (v->cycles.nb_measurements) {
-            const CheckasmVar raw     = checkasm_measurement_result(v->cycles);
-            const CheckasmVar raw_ref = checkasm_measurement_result(ref->cycles);
-
-            const CheckasmVar cycles     = checkasm_var_sub(raw, nop_cycles);
-            const CheckasmVar cycles_ref = checkasm_var_sub(raw_ref, nop_cycles);
-            const CheckasmVar ratio      = checkasm_var_div(cycles_ref, cycles);
-            const CheckasmVar raw_time   = checkasm_var_mul(raw, perf_scale);
+            const CheckasmVar cycles     = adjusted_cycles(v);
+            const CheckasmVar ratio      = speedup(ref, v);
             const CheckasmVar time       = checkasm_var_mul(cycles, perf_scale);
 
+            const CheckasmBaselineEntry *const base
+                = checkasm_baseline_find(&state.baseline, f->name, ver_suffix(v));
+            const CheckasmVar delta = base ? checkasm_var_div(cycles, base->cycles)
+                                           : checkasm_var_const(1.0);
+
+            /* Throughput figures, if the amount of work is known */
+            const CheckasmWork w         = v->work;
+            const double       bytes     = work_per_call(v, w.lbytes, w.nb_bytes);
+            const double       elems     = work_per_call(v, w.lelems, w.nb_elems);
+            const double       ops       = work_per_call(v, w.lops, w.nb_ops);
+            const CheckasmVar  var_elems = checkasm_var_const(elems);
+            const CheckasmVar  per_elem  = checkasm_var_div(cycles, var_elems);
+
+            /* Mean per-thread throughput under contention, relative to a single
+             * thread, and the matching time per call */
+            const CheckasmVar efficiency
+                = checkasm_var_scale(aggregate_throughput(v), 1.0 / cfg.bench_threads);
+            const CheckasmVar per_thread = checkasm_var_div(cycles, efficiency);
+
+            /* Plain rates are derived from the reported time instead, since the
+             * mode of a reciprocal is not the reciprocal of the mode */
+            const double time_mode = checkasm_mode(time);
+
+            /* Achieved fractions of the roofline, with cfg.roofline */
+            const CheckasmRoofline  *roof    = &state.roofline;
+            const CheckasmCacheState level   = roofline_level(bytes);
+            const double             bw_frac = bytes / time_mode / roof->bandwidth[level];
+            const double             op_frac = ops / time_mode / roof->peak_ops;
+
+            /* Clock frequency during the measurements, with cfg.telemetry */
+            const CheckasmTelemetry *const t = &v->telemetry;
+
             switch (cfg.format) {
             case CHECKASM_FORMAT_HTML:
             case CHECKASM_FORMAT_JSON:
@@ -406,19 +1048,71 @@ static void print_bench_iter(const CheckasmFunc *const f, struct IterState *cons
                 }
 
                 checkasm_json_push(json, ver_suffix(v), '{');
-                json_measurement(json, "rawCycles", checkasm_perf.unit, v->cycles);
-                json_var(json, "rawTime", "nsec", raw_time);
-                json_var(json, "adjustedCycles", checkasm_perf.unit, cycles);
-                json_var(json, "adjustedTime", "nsec", time);
-                if (v != ref && ref->cycles.nb_measurements)
-                    json_var(json, "ratio", NULL, checkasm_var_div(cycles_ref, cycles));
+                json_version(json, f, v);
                 checkasm_json_pop(json, '}'); /* close version */
                 break;
+            case CHECKASM_FORMAT_NDJSON: break;
             case CHECKASM_FORMAT_TSV:
             case CHECKASM_FORMAT_CSV:
-                printf("%s%c%s%c%.4f%c%.5f%c%.4f\n", f->name, sep, ver_suffix(v),
-                       sep, checkasm_mode(cycles), sep, checkasm_stddev(cycles), sep,
+                printf("%s%c%s%c%.4f%c%.5f%c%.4f", f->name, sep, ver_suffix(v), sep,
+                       checkasm_mode(cycles), sep, checkasm_stddev(cycles), sep,
                        checkasm_mode(time));
+                if (iter->has_threads) {
+                    printf("%c", sep);
+                    if (v->threaded_cycles.nb_measurements)
+                        printf("%.4f", checkasm_mode(per_thread));
+                    printf("%c", sep);
+                    if (v->threaded_cycles.nb_measurements)
+                        printf("%.4f", checkasm_mode(efficiency));
+                    printf("%c", sep);
+                    if (v->threaded_cycles.nb_measurements)
+                        printf("%.4f", cfg.bench_threads * checkasm_mode(efficiency));
+                }
+                if (iter->has_latency) {
+                    printf("%c", sep);
+                    if (v->latency.nb_measurements)
+                        printf("%.4f", checkasm_mode(adjusted_latency(v)));
+                }
+                if (iter->has_work) {
+                    printf("%c", sep);
+                    if (elems)
+                        printf("%.4f", checkasm_mode(per_elem));
+                    printf("%c", sep);
+                    if (elems)
+                        printf("%.0f", 1e9 * elems / time_mode);
+                    printf("%c", sep);
+                    if (bytes)
+                        printf("%.4f", bytes / time_mode);
+                }
+                if (iter->has_ops) {
+                    printf("%c", sep);
+                    if (ops)
+                        printf("%.4f", ops / time_mode);
+                }
+                if (iter->has_work && cfg.roofline) {
+                    printf("%c", sep);
+                    if (bytes)
+                        printf("%s", cache_state_names[level]);
+                    printf("%c", sep);
+                    if (bytes)
+                        printf("%.4f", bw_frac);
+                    printf("%c", sep);
+                    if (ops)
+                        printf("%.4f", op_frac);
+                }
+                if (iter->has_telemetry) {
+                    printf("%c", sep);
+                    if (t->nb_ratios)
+                        printf("%.4f", clock_ratio(t));
+                    printf("%c", sep);
+                    if (t->nb_ratios)
+                        printf("%.4f", clock_drift(t));
+                    printf("%c", sep);
+                    if (t->nb_temps)
+                        printf("%.1f", t->temp_max);
+                    printf("%c%d", sep, t->unstable);
+                }
+                printf("\n");
                 break;
             case CHECKASM_FORMAT_PRETTY:;
                 const int pad = 12 + state.max_function_name_length
@@ -428,6 +1122,21 @@ static void print_bench_iter(const CheckasmFunc *const f, struct IterState *cons
                     printf(" +/- %-7.1f %11.1f ns +/- %-6.1f", checkasm_stddev(cycles),
                            checkasm_mode(time), checkasm_stddev(time));
                 }
+                if (v->threaded_cycles.nb_measurements) {
+                    printf(" %9.1f (%3.0f%%) %5.1fx", checkasm_mode(per_thread),
+                           100.0 * checkasm_mode(efficiency),
+                           cfg.bench_threads * checkasm_mode(efficiency));
+                } else if (iter->has_threads) {
+                    printf(" %23s", "-");
+                }
+                if (v->latency.nb_measurements)
+                    printf(" %10.1f", checkasm_mode(adjusted_latency(v)));
+                else if (iter->has_latency)
+                    printf(" %10s", "-");
+                if (v->cold_cycles.nb_measurements)
+                    printf(" %12.1f", checkasm_mode(adjusted_cold_cycles(v)));
+                else if (cfg.cache_state != CHECKASM_CACHE_HOT)
+                    printf(" %12s", "-");
                 if (v != ref && ref->cycles.nb_measurements) {
                     const double ratio_lo = checkasm_sample(ratio, -1.0);
                     const double ratio_hi = checkasm_sample(ratio, 1.0);
@@ -439,6 +1148,42 @@ static void print_bench_iter(const CheckasmFunc *const f, struct IterState *cons
                     checkasm_fprintf(stdout, color, "%5.2fx", checkasm_mode(ratio));
                     printf(")");
                 }
+                if (base) {
+                    /* Only highlight statistically significant changes */
+                    const int color = checkasm_sample(delta, -1.96) > 1.0 ? COLOR_RED
+                                    : checkasm_sample(delta, 1.96) < 1.0  ? COLOR_GREEN
+                                                                          : COLOR_DEFAULT;
+                    printf(" [");
+                    checkasm_fprintf(stdout, color, "%+.1f%%",
+                                     100.0 * (checkasm_mode(delta) - 1.0));
+                    printf(" vs baseline]");
+                }
+                if (elems) {
+                    printf(" {%.3f %ss/elem, %.1f Melem/s", checkasm_mode(per_elem),
+                           checkasm_perf.unit, 1e3 * elems / time_mode);
+                }
+                if (bytes)
+                    /* bytes per nanosecond = GB/s */
+                    printf("%s%.2f GB/s", elems ? ", " : " {", bytes / time_mode);
+                if (ops)
+                    printf("%s%.2f Gop/s", elems || bytes ? ", " : " {", ops / time_mode);
+                if (bytes && cfg.roofline)
+                    printf(", %.0f%% of %s bw", 100.0 * bw_frac,
+                           cache_state_names[level]);
+                if (ops && cfg.roofline)
+                    printf(", %.0f%% of peak", 100.0 * op_frac);
+                if (elems || bytes || ops)
+                    printf("}");
+                if (t->nb_ratios) {
+                    printf(" [%.2fx clock, %.1f%% drift", clock_ratio(t),
+                           100.0 * clock_drift(t));
+                    if (cfg.verbose && t->nb_temps)
+                        printf(", %.0f °C", t->temp_max);
+                    if (t->unstable)
+                        checkasm_fprintf(stdout, COLOR_YELLOW, ", %d unstable",
+                                         t->unstable);
+                    printf("]");
+                }
                 printf("\n");
                 break;
             }
@@ -455,43 +1200,509 @@ static void print_bench_iter(const CheckasmFunc *const f, struct IterState *cons
 
 static void print_benchmarks(void)
 {
-    struct IterState iter = { .json.file = stdout };
+    const CheckasmFunc *const root = checkasm_func_tree_sorted(&current.tree);
+
+    struct IterState iter = {
+        .json.file   = stdout,
+        .has_work    = any_version(root, has_work),
+        .has_ops     = any_version(root, has_ops),
+        .has_latency = any_version(root, has_latency),
+        .has_threads   = any_version(root, has_threads),
+        .has_telemetry = any_version(root, has_telemetry),
+    };
+    sum_rejects(root, &iter.rejects);
     print_bench_header(&iter);
-    print_bench_iter(current.tree.root, &iter);
+    print_bench_iter(root, &iter);
     print_bench_footer(&iter);
     assert(iter.json.level == 0);
 }
 
+/* Each line of the NDJSON output is a separate, self-contained JSON object */
+static void ndjson_begin(CheckasmJson *json, const char *type)
+{
+    *json = (CheckasmJson) { .file = stdout, .compact = 1 };
+    checkasm_json_push(json, NULL, '{');
+    checkasm_json_str(json, "type", type);
+}
+
+static void ndjson_end(CheckasmJson *json)
+{
+    checkasm_json_pop(json, '}');
+    assert(json->level == 0);
+    fputc('\n', stdout);
+    /* Flush every line so that consumers see it immediately, and so that
+     * output from forked processes never interleaves mid-line */
+    fflush(stdout);
+}
+
+static void print_ndjson_header(void)
+{
+    CheckasmJson json;
+    ndjson_begin(&json, "header");
+    checkasm_json_str(&json, "checkasmVersion", CHECKASM_VERSION);
+    checkasm_json(&json, "iteration", "%d", state.test_iter);
+    json_run_info(&json);
+    ndjson_end(&json);
+}
+
+/* Print all function versions benchmarked as part of the current report group
+ * which have not been printed yet, in the order they were checked */
+static void print_ndjson_results(CheckasmFunc *const f)
+{
+    if (!f)
+        return;
+
+    print_ndjson_results(f->prev);
+    for (CheckasmFuncVersion *v = &f->versions; v; v = v->next) {
+        if (v->streamed || v->state != CHECKASM_FUNC_OK || !v->cycles.nb_measurements)
+            continue;
+
+        CheckasmJson json;
+        ndjson_begin(&json, "result");
+        checkasm_json_str(&json, "testName", f->test_name);
+        if (f->report_name)
+            checkasm_json_str(&json, "reportName", f->report_name);
+        checkasm_json_str(&json, "function", f->name);
+        checkasm_json_str(&json, "version", ver_suffix(v));
+        json_version(&json, f, v);
+        ndjson_end(&json);
+        v->streamed = 1;
+    }
+}
+
+static void print_ndjson_footer(const int interrupted)
+{
+    CheckasmRejects rejects = { 0 };
+    sum_rejects(checkasm_func_tree_sorted(&current.tree), &rejects);
+
+    CheckasmJson json;
+    ndjson_begin(&json, "footer");
+    checkasm_json(&json, "numChecked", "%d", current.num_checked);
+    checkasm_json(&json, "numFailed", "%d", current.num_failed);
+    checkasm_json(&json, "numBenchmarks", "%d", current.num_benched);
+    checkasm_json(&json, "numFunctions", "%d", current.num_funcs);
+    if (interrupted)
+        checkasm_json(&json, "interrupted", "true");
+    if (current.num_benched) {
+        checkasm_json(&json, "averageError", "%g",
+                      relative_error(current.var_sum / current.num_benched));
+        checkasm_json(&json, "maximumError", "%g", relative_error(current.var_max));
+    }
+    if (rejects.batches) {
+        checkasm_json(&json, "totalBatches", "%" PRIu64, rejects.batches);
+        checkasm_json(&json, "rejectedBatches", "%" PRIu64, rejects.rejected);
+    }
+    ndjson_end(&json);
+}
+
+#define FINGERPRINT_SIZE 512
+
+static void fingerprint_append(void *priv, const char *fmt, ...)
+{
+    char *const  fp  = priv;
+    const size_t len = strlen(fp);
+    snprintf(fp + len, FINGERPRINT_SIZE - len, "; ");
+
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(fp + len + 2, FINGERPRINT_SIZE - len - 2, fmt, ap);
+    va_end(ap);
+}
+
+/* Describes the system and timer, to detect comparisons across systems */
+static void get_fingerprint(char fp[FINGERPRINT_SIZE])
+{
+    snprintf(fp, FINGERPRINT_SIZE, "%s (%s)", checkasm_perf.name, checkasm_perf.unit);
+    checkasm_cpu_info(fingerprint_append, fp, &cfg);
+}
+
+static void collect_baseline(const CheckasmFunc *const f, CheckasmBaseline *const out)
+{
+    if (!f)
+        return;
+
+    collect_baseline(f->child[0], out);
+    for (const CheckasmFuncVersion *v = &f->versions; v; v = v->next) {
+        if (v->cycles.nb_measurements) {
+            checkasm_baseline_add(out, f->name, ver_suffix(v), adjusted_cycles(v),
+                                  v->cycles.stats.nb_samples);
+        }
+    }
+    collect_baseline(f->child[1], out);
+}
+
+static int save_baseline(void)
+{
+    char             fp[FINGERPRINT_SIZE];
+    CheckasmBaseline baseline = { 0 };
+    get_fingerprint(fp);
+    baseline.fingerprint = checkasm_strdup(fp);
+    collect_baseline(checkasm_func_tree_sorted(&current.tree), &baseline);
+
+    const int ret = checkasm_baseline_write(&baseline, cfg.save_baseline);
+    checkasm_baseline_uninit(&baseline);
+    return ret;
+}
+
+/* Returns the number of significant slowdowns exceeding the threshold */
+static int check_baseline(const CheckasmFunc *const f)
+{
+    if (!f)
+        return 0;
+
+    int regressions = check_baseline(f->child[0]);
+    for (const CheckasmFuncVersion *v = &f->versions; v; v = v->next) {
+        const CheckasmBaselineEntry *const base
+            = checkasm_baseline_find(&state.baseline, f->name, ver_suffix(v));
+        if (!base || !v->cycles.nb_measurements)
+            continue;
+
+        const CheckasmVar delta = checkasm_var_div(adjusted_cycles(v), base->cycles);
+        const double      lower = checkasm_sample(delta, -1.96);
+        if (lower > 1.0 && checkasm_mode(delta) > 1.0 + cfg.regression_threshold / 100.0) {
+            LOG_COLOR(COLOR_RED,
+                      "checkasm: %s_%s regressed by %.1f%% vs baseline "
+                      "(95%% CI: %.1f%% to %.1f%%)\n",
+                      f->name, ver_suffix(v), 100.0 * (checkasm_mode(delta) - 1.0),
+                      100.0 * (lower - 1.0),
+                      100.0 * (checkasm_sample(delta, 1.96) - 1.0));
+            regressions++;
+        }
+    }
+
+    return regressions + check_baseline(f->child[1]);
+}
+
+static int load_baseline(void)
+{
+    if (checkasm_baseline_read(&state.baseline, cfg.compare_baseline))
+        return 1;
+
+    char fp[FINGERPRINT_SIZE];
+    get_fingerprint(fp);
+    if (strcmp(fp, state.baseline.fingerprint)) {
+        LOG_COLOR(COLOR_YELLOW,
+                  "checkasm: warning: baseline was recorded on a different system "
+                  "(%s)\n",
+                  state.baseline.fingerprint);
+    }
+    return 0;
+}
+
+static int open_checkpoint(const int random_seed)
+{
+    char fp[FINGERPRINT_SIZE];
+    get_fingerprint(fp);
+    if (checkasm_checkpoint_open(&state.checkpoint, cfg.checkpoint_file, fp, cfg.seed,
+                                 cfg.resume))
+        return 1;
+
+    /* Results are only reused for the same seed, so continue with the seed of
+     * the interrupted run unless a different one was requested explicitly */
+    if (random_seed)
+        cfg.seed = state.checkpoint.seed;
+    if (state.checkpoint.nb_entries) {
+        LOG("checkasm: resuming %d finished benchmarks from %s\n",
+            state.checkpoint.nb_entries, cfg.checkpoint_file);
+    }
+    return 0;
+}
+
+/* Reuse the results of a previous run for the current function version, if
+ * it was saved to cfg.checkpoint_file */
+static int restore_checkpoint(CheckasmFuncVersion *const v)
+{
+    if (!checkasm_checkpoint_restore(&state.checkpoint, current.test_name,
+                                     current.func->name, ver_suffix(v), cfg.seed, v,
+                                     &current.tree.arena))
+        return 0;
+
+    /* Only the last measurement's variance is known, which is exact for the
+     * usual case of a single checkasm_bench() call per function */
+    const CheckasmVar cycles = checkasm_stats_estimate(&v->cycles.stats);
+    current.var_sum += cycles.lvar * v->cycles.nb_measurements;
+    current.var_max = fmax(current.var_max, cycles.lvar);
+    current.num_benched += v->cycles.nb_measurements;
+    v->checkpointed = 1;
+    return 1;
+}
+
+/* Durably save all function versions benchmarked as part of the current report
+ * group, once they are final */
+static void save_checkpoint(CheckasmFunc *const f)
+{
+    if (!f)
+        return;
+
+    save_checkpoint(f->prev);
+    for (CheckasmFuncVersion *v = &f->versions; v; v = v->next) {
+        if (v->checkpointed || v->state != CHECKASM_FUNC_OK || !v->cycles.nb_measurements)
+            continue;
+        if (!state.checkpoint.file)
+            return; /* disabled after a write error */
+
+        if (checkasm_checkpoint_add(&state.checkpoint, current.test_name, f->name,
+                                    ver_suffix(v), cfg.seed, v)) {
+            checkasm_checkpoint_close(&state.checkpoint);
+            return;
+        }
+        v->checkpointed = 1;
+    }
+}
+
+/* Maximum benchmark duration with --precision, relative to --duration */
+#define PRECISION_TIME_CAP 10
+
 /* Decide whether or not the current function needs to be benchmarked */
 int checkasm_bench_func(void)
 {
-    return !current.num_failed && cfg.bench && !checkasm_interrupted;
+    return !current.num_failed && cfg.bench && !checkasm_interrupted && !current.resumed;
 }
 
-int checkasm_bench_runs(void)
+/* Number of single calls to time with cold caches, per function */
+#define COLD_SAMPLES 32
+
+/* Minimum number of single calls to time with cfg.bench_quantiles, enough to
+ * resolve the 99.9th percentile */
+#define TAIL_SAMPLES 1000
+
+/* The regular ~1.5% growth of the batch size only stretches the sample array to
+ * a few times the time budget, which is not enough for the precision time cap.
+ * Instead, spread the time left until the cap over the remaining samples */
+static void precision_count_grow(void)
 {
-    if (checkasm_interrupted)
-        return 0;
+    const uint64_t cap = PRECISION_TIME_CAP * state.target_cycles;
+    if (current.cycles >= cap)
+        return;
+
+    const CheckasmSample last       = stats.samples[stats.nb_samples - 1];
+    const int            left       = CHECKASM_STATS_SAMPLES - stats.nb_samples;
+    const double         per_sample = (double) (cap - current.cycles) / left;
+    const double         wanted     = per_sample * last.count / last.sum;
+    if (wanted > stats.next_count)
+        stats.next_count = (int) fmin(wanted, 1 << 25);
+}
 
-    /* This limit should be impossible to hit in practice */
+static int warm_bench_runs(void)
+{
+    /* Only reachable by extremely fast functions, whose batches are capped at
+     * 1 << 25 calls, since the batch sizes are grown to fit the time budget
+     * (or the precision time cap) into the number of samples */
     if (stats.nb_samples == CHECKASM_STATS_SAMPLES)
         return 0;
 
     /* Try and gather at least 30 samples for statistical validity, even if
      * it means exceeding the time budget */
-    if (current.cycles < state.target_cycles || stats.nb_samples < 30)
+    if (stats.nb_samples < 30)
         return stats.next_count;
-    else
+
+    if (cfg.bench_precision) {
+        /* Keep going until the estimate is precise enough, or we run out of
+         * time (as a safety net for extremely noisy functions) */
+        if (current.cycles >= PRECISION_TIME_CAP * state.target_cycles)
+            return 0;
+        const double error = checkasm_stats_precision(&stats);
+        if (error <= cfg.bench_precision / 100.0)
+            return 0;
+        precision_count_grow();
+        return stats.next_count;
+    }
+
+    return current.cycles < state.target_cycles ? stats.next_count : 0;
+}
+
+static int cold_bench_runs(void)
+{
+    /* Give up eventually if the timer is too coarse for single calls */
+    if (stats.nb_samples == COLD_SAMPLES || current.cold_calls++ > 4 * COLD_SAMPLES)
+        return 0;
+
+    /* Each cold sample is a single call, preceded by cache eviction */
+    checkasm_evict_cache(cfg.cache_state);
+    return 1;
+}
+
+static int tail_bench_runs(void)
+{
+    if (current.cycles >= PRECISION_TIME_CAP * state.target_cycles)
+        return 0;
+    return current.quantiles.count < TAIL_SAMPLES || current.cycles < state.target_cycles;
+}
+
+static void bench_store(void);
+static void bench_reset(void);
+#if HAVE_FORK
+static void start_bench_workers(void);
+static void stop_bench_workers(CheckasmStats *results);
+static int  bench_worker_runs(void);
+#endif
+
+int checkasm_bench_latency_func(void)
+{
+    current.bench_latency = checkasm_bench_func();
+    return current.bench_latency;
+}
+
+int checkasm_bench_serial(void)
+{
+    return current.bench_phase == BENCH_LATENCY;
+}
+
+CheckasmKey checkasm_bench_paired(const CheckasmKey key)
+{
+    const CheckasmFuncVersion *const v = current.func_ver;
+
+    /* Only pair the function that was checked, and never the reference itself */
+    if (!cfg.bench_paired || current.bench_phase != BENCH_THROUGHPUT || !v
+        || v->key != key || v == &current.func->versions)
+        return 0;
+    return current.func->versions.key;
+}
+
+void checkasm_bench_paired_side(const int is_ref)
+{
+    current.paired_side_ref = is_ref;
+}
+
+void checkasm_bench_update_paired(const int iterations, const uint64_t cycles)
+{
+    current.paired_ref      = (CheckasmSample) { cycles, iterations };
+    current.paired_side_ref = 0;
+}
+
+/* Pair a batch of the current version with the reference batch timed next to it */
+static void paired_update(const int iterations, const uint64_t cycles)
+{
+    const CheckasmSample ref = current.paired_ref;
+    current.paired_ref       = (CheckasmSample) { 0 };
+    if (!ref.count || !iterations)
+        return;
+
+    /* Subtract the timer overhead, like adjusted_cycles() */
+    const double nop   = checkasm_mode(checkasm_measurement_result(state.nop_cycles));
+    const double t_ref = (double) ref.sum / ref.count - nop;
+    const double t_new = (double) cycles / iterations - nop;
+    if (t_ref > 0.0 && t_new > 0.0)
+        checkasm_paired_add(&current.paired, log(t_ref / t_new));
+}
+
+/* Relative change of the clock frequency beyond which a measurement is
+ * considered to have straddled a frequency transition, and how many times such
+ * a measurement is repeated before accepting it anyway */
+#define CLOCK_TOLERANCE 0.05
+#define CLOCK_RERUNS    3
+
+static const CheckasmTelemetrySample no_telemetry = { 0.0, NAN };
+
+static int clock_transition(const CheckasmTelemetrySample start,
+                            const CheckasmTelemetrySample end)
+{
+    return start.ratio > 0.0 && end.ratio > 0.0
+        && fabs(end.ratio / start.ratio - 1.0) > CLOCK_TOLERANCE;
+}
+
+/* Sample the clock at the end of a throughput measurement, and discard the
+ * measurement if the clock changed while it was running */
+static int telemetry_rerun(void)
+{
+    if (!state.telemetry || !current.func_ver || current.bench_phase != BENCH_THROUGHPUT)
+        return 0;
+
+    checkasm_telemetry_read(&current.telemetry_end);
+    if (!clock_transition(current.telemetry_start, current.telemetry_end)
+        || current.telemetry_reruns == CLOCK_RERUNS)
         return 0;
+
+    current.telemetry_reruns++;
+    bench_reset();
+    return 1;
+}
+
+int checkasm_bench_runs(void)
+{
+#if HAVE_FORK
+    if (state.bench_worker)
+        return bench_worker_runs();
+#endif
+    if (checkasm_interrupted)
+        return 0;
+
+    for (;;) {
+        const int runs = current.bench_phase == BENCH_COLD ? cold_bench_runs()
+                       : current.bench_phase == BENCH_TAIL ? tail_bench_runs()
+                                                           : warm_bench_runs();
+        if (runs && !current.cycles && state.telemetry && current.func_ver
+            && current.bench_phase == BENCH_THROUGHPUT)
+            checkasm_telemetry_read(&current.telemetry_start);
+        if (runs || !current.cycles)
+            return runs;
+
+        /* Done with this measurement, continue with the next one (if any) */
+        if (telemetry_rerun())
+            continue;
+        bench_store();
+        if (current.bench_phase < BENCH_THREADS && cfg.bench_threads > 1) {
+            current.bench_phase = BENCH_THREADS;
+#if HAVE_FORK
+            start_bench_workers();
+            if (state.bench_worker)
+                return bench_worker_runs();
+#endif
+        } else if (current.bench_phase < BENCH_LATENCY
+                   && (cfg.bench_latency || current.bench_latency)) {
+            current.bench_phase   = BENCH_LATENCY;
+            state.latency_benched = 1;
+        } else if (current.bench_phase < BENCH_TAIL && cfg.bench_quantiles
+                   && current.tail_eligible) {
+            current.bench_phase = BENCH_TAIL;
+        } else if (current.bench_phase < BENCH_COLD
+                   && cfg.cache_state != CHECKASM_CACHE_HOT) {
+            current.bench_phase = BENCH_COLD;
+        } else {
+            return 0;
+        }
+    }
+}
+
+/* Stream a sample to cfg.trace_file, announcing new function versions */
+static void trace_sample(const int iterations, const uint64_t cycles)
+{
+    CheckasmFuncVersion *const v = current.func_ver;
+#if HAVE_FORK
+    if (state.bench_worker)
+        return;
+#endif
+    if (!cfg.trace_file || !v)
+        return;
+
+    if (!v->trace_id) {
+        v->trace_id = checkasm_trace_name(current.test_name, current.func->name,
+                                          ver_suffix(v));
+    }
+    checkasm_trace_sample(v->trace_id, current.bench_phase, iterations, cycles);
 }
 
 /* Update benchmark results of the current function */
 void checkasm_bench_update(const int iterations, const uint64_t cycles)
 {
-    checkasm_stats_add(&stats, (CheckasmSample) { cycles, iterations });
-    checkasm_stats_count_grow(&stats, cycles, state.target_cycles);
+    trace_sample(iterations, cycles);
+
+    if (current.bench_phase == BENCH_TAIL) {
+        /* Single calls, only used for the latency distribution */
+        checkasm_histogram_add(&current.quantiles, cycles);
+    } else {
+        checkasm_stats_add(&stats, (CheckasmSample) { cycles, iterations });
+        checkasm_stats_count_grow(&stats, cycles, state.target_cycles);
+        paired_update(iterations, cycles);
+    }
     current.cycles += cycles;
 
+    if (checkasm_perf_counters.nb_counters) {
+        current.counters.iters += iterations;
+        for (int i = 0; i < checkasm_perf_counters.nb_counters; i++)
+            current.counters.values[i] += checkasm_perf_counters.values[i];
+    }
+
     /* Emit this periodically while benchmarking, to avoid the SIMD
      * units turning on and off during long bench runs of non-SIMD
      * functions */
@@ -500,23 +1711,139 @@ void checkasm_bench_update(const int iterations, const uint64_t cycles)
 #endif
 }
 
-void checkasm_bench_finish(void)
+static int cmp_u64(const void *a, const void *b)
 {
-    CheckasmFuncVersion *const v = current.func_ver;
-    if (v && current.cycles) {
+    const uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+void checkasm_bench_trim(const uint64_t *const times, const int nb, uint64_t *const sum,
+                         int *const count)
+{
+    if (!nb)
+        return;
+    assert(nb <= CHECKASM_TRIM_WINDOW);
+
+    /* Range of batch timings to keep, for the window based methods */
+    uint64_t lo = 0, hi = UINT64_MAX;
+    if (cfg.outliers == CHECKASM_OUTLIERS_MAD || cfg.outliers == CHECKASM_OUTLIERS_TRIM) {
+        uint64_t sorted[CHECKASM_TRIM_WINDOW];
+        memcpy(sorted, times, nb * sizeof(*times));
+        qsort(sorted, nb, sizeof(*sorted), cmp_u64);
+
+        if (cfg.outliers == CHECKASM_OUTLIERS_TRIM) {
+            hi = sorted[nb - 1 - nb / 10];
+        } else {
+            const uint64_t median = sorted[nb / 2];
+            for (int i = 0; i < nb; i++)
+                sorted[i] = sorted[i] > median ? sorted[i] - median : median - sorted[i];
+            qsort(sorted, nb, sizeof(*sorted), cmp_u64);
+
+            /* Modified z-score of 3.5 (Iglewicz and Hoaglin), with the MAD
+             * clamped to the timer resolution */
+            const double   mad   = sorted[nb / 2] ? (double) sorted[nb / 2] : 1.0;
+            const uint64_t limit = (uint64_t) (3.5 / 0.6745 * mad);
+            lo = median > limit ? median - limit : 0;
+            hi = median + limit;
+        }
+    }
+
+    for (int i = 0; i < nb; i++) {
+        const uint64_t t    = times[i];
+        const int      keep = cfg.outliers == CHECKASM_OUTLIERS_RATIO
+                                ? t * *count <= *sum * 4
+                                : t >= lo && t <= hi;
+        if (keep) {
+            *sum += t;
+            (*count)++;
+        } else if (!current.paired_side_ref) {
+            current.rejects.rejected++;
+        }
+    }
+
+    if (!current.paired_side_ref)
+        current.rejects.batches += nb;
+}
+
+/* Store the results gathered so far for the current function, and reset */
+static void bench_store(void)
+{
+    CheckasmFuncVersion *const v       = current.func_ver;
+    CheckasmStats              workers = { 0 };
+#if HAVE_FORK
+    if (current.bench_phase == BENCH_THREADS)
+        stop_bench_workers(&workers);
+#endif
+
+    if (v && current.cycles && current.bench_phase == BENCH_THREADS) {
+        checkasm_measurement_update(&v->threaded_cycles, stats);
+        if (workers.nb_samples)
+            checkasm_measurement_update(&v->worker_cycles, workers);
+    } else if (v && current.cycles && current.bench_phase == BENCH_LATENCY) {
+        checkasm_measurement_update(&v->latency, stats);
+    } else if (v && current.cycles && current.bench_phase == BENCH_COLD) {
+        checkasm_measurement_update(&v->cold_cycles, stats);
+    } else if (v && current.cycles && current.bench_phase == BENCH_TAIL) {
+        if (!v->quantiles)
+            v->quantiles = checkasm_arena_alloc(&current.tree.arena, sizeof(*v->quantiles));
+        checkasm_histogram_merge(v->quantiles, &current.quantiles);
+        memset(&current.quantiles, 0, sizeof(current.quantiles));
+    } else if (v && current.cycles) {
         const CheckasmVar cycles = checkasm_stats_estimate(&stats);
 
         /* Accumulate multiple bench_new() calls */
         checkasm_measurement_update(&v->cycles, stats);
+        checkasm_counters_add(&v->counters, current.counters);
+        checkasm_rejects_add(&v->rejects, current.rejects);
+        checkasm_work_update(&v->work, current.work_bytes, current.work_elems,
+                             current.work_ops);
+        if (state.telemetry) {
+            const CheckasmTelemetrySample start = current.telemetry_start;
+            const CheckasmTelemetrySample end   = current.telemetry_end;
+            checkasm_telemetry_update(&v->telemetry, start.ratio, end.ratio,
+                                      fmax(start.temp, end.temp));
+            v->telemetry.unstable += clock_transition(start, end);
+            v->telemetry.reruns += current.telemetry_reruns;
+        }
+        checkasm_paired_merge(&v->paired, current.paired);
 
         /* Keep track of min/max/avg (log) variance */
         current.var_sum += cycles.lvar;
         current.var_max = fmax(current.var_max, cycles.lvar);
         current.num_benched++;
+
+        /* Only time single calls if they aren't dominated by the timer overhead */
+        if (cfg.bench_quantiles) {
+            const CheckasmVar nop = checkasm_measurement_result(state.nop_cycles_single);
+            current.tail_eligible = checkasm_mode(cycles) >= checkasm_mode(nop);
+        }
     }
 
+    current.telemetry_reruns = 0;
+    bench_reset();
+}
+
+/* Discard the measurement in progress */
+static void bench_reset(void)
+{
     checkasm_stats_reset(&stats);
-    current.cycles = 0;
+    current.cycles          = 0;
+    current.counters        = (CheckasmCounters) { 0 };
+    current.rejects         = (CheckasmRejects) { 0 };
+    current.telemetry_start = current.telemetry_end = no_telemetry;
+    current.paired          = (CheckasmPaired) { 0 };
+
+    /* Nothing may be left buffered when forking bench workers or children */
+    checkasm_trace_flush();
+}
+
+void checkasm_bench_finish(void)
+{
+    bench_store();
+    current.bench_phase   = BENCH_THROUGHPUT;
+    current.bench_latency = 0;
+    current.cold_calls    = 0;
+    current.tail_eligible = 0;
 }
 
 /* Compares a string with a wildcard pattern. */
@@ -541,27 +1868,36 @@ static int wildstrcmp(const char *str, const char *pattern)
 
 static void handle_interrupt(void);
 static void update_statusline(void);
+#if HAVE_FORK
+static NORETURN void child_exit(int status);
+#endif
 
 static int test_enabled(const CheckasmTest *test)
 {
     return !cfg.test_pattern || !wildstrcmp(test->name, cfg.test_pattern);
 }
 
-/* Perform tests and benchmarks for the specified
- * cpu flag if supported by the host */
-static void check_cpu_flag(const CheckasmCpuInfo *cpu)
+/* Perform tests and benchmarks for the specified cpu flag if supported by the
+ * host. If `only` is set, run only that test instead of all enabled tests. */
+/* CPU flags to test `cpu` with, following on from `flags` */
+static CheckasmCpu next_cpu_flags(CheckasmCpu flags, const CheckasmCpuInfo *cpu)
 {
-    const CheckasmCpu prev_cpu_flags = current.cpu_flags;
     if (cpu) {
-        current.cpu_flags &= ~cpu->mask;
-        current.cpu_flags |= cpu->flag & cfg.cpu;
+        flags &= ~cpu->mask;
+        flags |= cpu->flag & cfg.cpu;
     } else {
         /* Also include any CPU flags not related to the CPU flags list */
-        current.cpu_flags = cfg.cpu;
+        flags = cfg.cpu;
         for (const CheckasmCpuInfo *info = cfg.cpu_flags; info->flag; info++)
-            current.cpu_flags &= ~info->flag;
+            flags &= ~info->flag;
     }
+    return flags;
+}
 
+static void check_cpu_flag(const CheckasmCpuInfo *cpu, const CheckasmTest *only)
+{
+    const CheckasmCpu prev_cpu_flags = current.cpu_flags;
+    current.cpu_flags                = next_cpu_flags(prev_cpu_flags, cpu);
     if (cpu && current.cpu_flags == prev_cpu_flags)
         return;
 
@@ -574,7 +1910,7 @@ static void check_cpu_flag(const CheckasmCpuInfo *cpu)
         cfg.set_cpu_flags(current.cpu_flags);
 
     for (const CheckasmTest *test = cfg.tests; test->func; test++) {
-        if (!test_enabled(test))
+        if (!test_enabled(test) || (only && test != only))
             continue;
         current.test_name = test->name;
         update_statusline();
@@ -593,6 +1929,16 @@ static void check_cpu_flag(const CheckasmCpuInfo *cpu)
             current.num_failed      = current.prev_failed;
             current.num_checked     = current.prev_checked;
             current.func            = NULL;
+#if HAVE_FORK
+            /* Crashed while running a contention benchmark */
+            if (state.bench_worker)
+                _exit(1);
+            stop_bench_workers(NULL);
+
+            /* Don't trust the state of this process any further */
+            if (state.isolated)
+                child_exit(0);
+#endif
         }
 
         checkasm_srand(cfg.seed);
@@ -604,6 +1950,13 @@ static void check_cpu_flag(const CheckasmCpuInfo *cpu)
             /* Measure NOP and perf scale after each test+CPU flag configuration */
             handle_interrupt();
             checkasm_measure_nop_cycles(&state.nop_cycles, state.target_cycles);
+            if (cfg.cache_state != CHECKASM_CACHE_HOT || cfg.bench_quantiles)
+                checkasm_measure_nop_cycles_single(&state.nop_cycles_single);
+            if (state.latency_benched) {
+                checkasm_measure_nop_cycles_serial(&state.nop_cycles_serial,
+                                                   state.target_cycles);
+                state.latency_benched = 0;
+            }
             handle_interrupt();
             checkasm_measure_perf_scale(&state.perf_scale);
         }
@@ -730,9 +2083,9 @@ static void run_all_tests(void)
         }
     }
 
-    check_cpu_flag(NULL);
+    check_cpu_flag(NULL, NULL);
     for (const CheckasmCpuInfo *info = cfg.cpu_flags; info->flag; info++)
-        check_cpu_flag(info);
+        check_cpu_flag(info, NULL);
 
     for (const CheckasmTest *test = cfg.tests; test->func; test++) {
         if (test->uninit && test_enabled(test))
@@ -740,6 +2093,515 @@ static void run_all_tests(void)
     }
 }
 
+#if HAVE_FORK
+
+/* Results of a child process, merged into `current` by the parent */
+typedef struct ChildStats {
+    int    num_funcs, num_checked, num_failed, num_benched;
+    int    prev_checked, prev_failed, saved_checked, saved_failed;
+    int    max_function_name_length;
+    double var_sum, var_max;
+
+    /* Where to resume after a crash (see run_test_isolated()) */
+    int         next_cpu; /* 0 = C, otherwise index into cfg.cpu_flags + 1 */
+    CheckasmCpu cpu_flags;
+} ChildStats;
+
+/* Send the results of this child process back to the parent and exit */
+static NORETURN void child_exit(const int status)
+{
+    const ChildStats cs = {
+        .num_funcs                = current.num_funcs,
+        .num_checked              = current.num_checked,
+        .num_failed               = current.num_failed,
+        .num_benched              = current.num_benched,
+        .prev_checked             = current.prev_checked,
+        .prev_failed              = current.prev_failed,
+        .saved_checked            = current.saved_checked,
+        .saved_failed             = current.saved_failed,
+        .max_function_name_length = state.max_function_name_length,
+        .var_sum                  = current.var_sum,
+        .var_max                  = current.var_max,
+        .next_cpu                 = state.next_cpu,
+        .cpu_flags                = state.next_cpu_flags,
+    };
+
+    FILE *const f = state.child_results;
+    fflush(stderr);
+    if (fwrite(&cs, sizeof(cs), 1, f) != 1 || checkasm_func_tree_write(&current.tree, f))
+        _exit(1);
+    _exit(status);
+}
+
+static void merge_child_stats(const ChildStats *const cs)
+{
+    current.num_funcs += cs->num_funcs;
+    current.num_checked += cs->num_checked;
+    current.num_failed += cs->num_failed;
+    current.num_benched += cs->num_benched;
+    current.var_sum += cs->var_sum;
+    current.var_max = fmax(current.var_max, cs->var_max);
+    state.max_function_name_length
+        = imax(state.max_function_name_length, cs->max_function_name_length);
+}
+
+/* Run a single test on all CPU flags, starting from the specified index */
+static void run_test(const CheckasmTest *const test, const int first_cpu)
+{
+    if (test->init) {
+        checkasm_srand(cfg.seed);
+        test->init();
+    }
+
+    int i = first_cpu;
+    for (; !i || cfg.cpu_flags[i - 1].flag; i++) {
+        state.next_cpu       = i;
+        state.next_cpu_flags = current.cpu_flags;
+        check_cpu_flag(i ? &cfg.cpu_flags[i - 1] : NULL, test);
+    }
+    state.next_cpu = i;
+
+    if (test->uninit)
+        test->uninit();
+}
+
+static int wait_child(const pid_t pid)
+{
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR)
+            return -1;
+    }
+
+    if (checkasm_interrupted && WIFEXITED(status) && WEXITSTATUS(status) > 128)
+        return 0; /* child stopped early; results are still valid */
+    return status;
+}
+
+/* Run a single test in a fresh child process. If the child crashes, it reports
+ * its results up to that point, and a new child picks up where it left off, so
+ * that memory corruption can never leak into subsequent functions or tests.
+ * A child that dies without reporting anything loses the CPU flag it was on */
+static void run_test_isolated(const CheckasmTest *const test)
+{
+    CheckasmFuncTree tree     = { 0 };
+    ChildStats       cs       = { 0 };
+    int              num_cpus = 0;
+    while (cfg.cpu_flags[num_cpus].flag)
+        num_cpus++;
+    cs.max_function_name_length = state.max_function_name_length;
+
+    while (cs.next_cpu <= num_cpus && !checkasm_interrupted) {
+        int fds[2];
+        if (pipe(fds)) {
+            perror("checkasm: pipe");
+            current.num_failed++;
+            break;
+        }
+
+        fflush(stdout);
+        fflush(stderr);
+        const pid_t pid = fork();
+        if (pid < 0) {
+            perror("checkasm: fork");
+            close(fds[0]);
+            close(fds[1]);
+            current.num_failed++;
+            break;
+        } else if (!pid) {
+            checkasm_perf_fork_child();
+            close(fds[0]);
+            if (!(state.child_results = fdopen(fds[1], "wb")))
+                _exit(1);
+            state.isolated                 = 1;
+            state.max_function_name_length = cs.max_function_name_length;
+            current.tree                   = tree;
+            current.cpu_flags     = cs.cpu_flags;
+            current.num_funcs     = cs.num_funcs;
+            current.num_checked   = cs.num_checked;
+            current.num_failed    = cs.num_failed;
+            current.num_benched   = cs.num_benched;
+            current.prev_checked  = cs.prev_checked;
+            current.prev_failed   = cs.prev_failed;
+            current.saved_checked = cs.saved_checked;
+            current.saved_failed  = cs.saved_failed;
+            current.var_sum       = cs.var_sum;
+            current.var_max       = cs.var_max;
+            run_test(test, cs.next_cpu);
+            child_exit(0);
+        }
+
+        /* Stream the results back, then replace the partial state with them */
+        close(fds[1]);
+        FILE *const      f         = fdopen(fds[0], "rb");
+        CheckasmFuncTree next_tree = { 0 };
+        ChildStats       next;
+        const int        err = !f || fread(&next, sizeof(next), 1, f) != 1
+                        || checkasm_func_tree_read(&next_tree, f);
+        if (f)
+            fclose(f);
+        else
+            close(fds[0]);
+
+        const int status = wait_child(pid);
+        if (err || status) {
+            /* It got at least as far as the next CPU flag, so skip that one */
+            const CheckasmCpuInfo *const cpu
+                = cs.next_cpu ? &cfg.cpu_flags[cs.next_cpu - 1] : NULL;
+            checkasm_func_tree_uninit(&next_tree);
+            checkasm_statusline(NULL);
+            if (status > 0 && WIFSIGNALED(status)) {
+                LOG_COLOR(COLOR_RED, "checkasm: test %s (%s) terminated by signal %d\n",
+                          test->name, cpu ? cpu->name : "C", WTERMSIG(status));
+            } else {
+                LOG_COLOR(COLOR_RED, "checkasm: test %s (%s) terminated abnormally\n",
+                          test->name, cpu ? cpu->name : "C");
+            }
+            cs.num_failed++;
+            cs.prev_failed++; /* not part of any report group */
+            cs.cpu_flags = next_cpu_flags(cs.cpu_flags, cpu);
+            cs.next_cpu++;
+            continue;
+        }
+
+        checkasm_func_tree_uninit(&tree);
+        tree = next_tree;
+        cs   = next;
+    }
+
+    checkasm_func_tree_merge(&current.tree, &tree);
+    merge_child_stats(&cs);
+}
+
+/* Pull test indices from the shared queue until it runs dry */
+static NORETURN void run_worker(const int queue, FILE **const logs)
+{
+    int idx;
+    while (read(queue, &idx, sizeof(idx)) == sizeof(idx)) {
+        const CheckasmTest *const test = &cfg.tests[idx];
+
+        /* Give each test its own log, so the output can be replayed in order */
+        fflush(stderr);
+        dup2(fileno(logs[idx]), STDERR_FILENO);
+        checkasm_setup_fprintf();
+
+        if (cfg.isolate)
+            run_test_isolated(test);
+        else
+            run_test(test, 0);
+    }
+
+    child_exit(0);
+}
+
+/* Distribute all enabled tests across cfg.jobs worker processes */
+static int run_parallel(void)
+{
+    int num_tests = 0;
+    while (cfg.tests[num_tests].func)
+        num_tests++;
+    if (!num_tests)
+        return 0;
+
+    FILE **const logs    = checkasm_mallocz(num_tests * sizeof(*logs));
+    FILE **const results = checkasm_mallocz(cfg.jobs * sizeof(*results));
+    pid_t *const pids    = checkasm_mallocz(cfg.jobs * sizeof(*pids));
+    int          queue[2], ret = 1;
+
+    if (pipe(queue)) {
+        perror("checkasm: pipe");
+        goto end;
+    }
+
+    for (int i = 0; i < num_tests; i++) {
+        if (test_enabled(&cfg.tests[i]) && !(logs[i] = tmpfile())) {
+            perror("checkasm: tmpfile");
+            goto end;
+        }
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    for (unsigned j = 0; j < cfg.jobs; j++) {
+        if (!(results[j] = tmpfile())) {
+            perror("checkasm: tmpfile");
+            break;
+        }
+
+        pids[j] = fork();
+        if (pids[j] < 0) {
+            perror("checkasm: fork");
+            break;
+        } else if (!pids[j]) {
+            checkasm_perf_fork_child();
+            close(queue[1]);
+            state.child_results = results[j];
+            run_worker(queue[0], logs);
+        }
+    }
+
+    /* Feed the queue only after forking, so it can't fill up the pipe */
+    close(queue[0]);
+    for (int i = 0; i < num_tests; i++) {
+        if (logs[i] && write(queue[1], &i, sizeof(i)) != sizeof(i))
+            break;
+    }
+    close(queue[1]);
+
+    ret = 0;
+    for (unsigned j = 0; j < cfg.jobs && pids[j] > 0; j++) {
+        /* Only rewind once the worker is done, since it shares the file offset */
+        const int status = wait_child(pids[j]);
+        rewind(results[j]);
+
+        ChildStats cs;
+        if (status || fread(&cs, sizeof(cs), 1, results[j]) != 1
+            || checkasm_func_tree_read(&current.tree, results[j])) {
+            LOG_COLOR(COLOR_RED, "checkasm: worker %u terminated abnormally\n", j);
+            current.num_failed++;
+            continue;
+        }
+
+        merge_child_stats(&cs);
+    }
+
+    /* Replay the output of each test in the original order */
+    checkasm_statusline(NULL);
+    for (int i = 0; i < num_tests; i++) {
+        if (!logs[i])
+            continue;
+        char   buf[4096];
+        size_t len;
+        rewind(logs[i]);
+        while ((len = fread(buf, 1, sizeof(buf), logs[i])))
+            fwrite(buf, 1, len, stderr);
+    }
+
+end:
+    for (int i = 0; i < num_tests; i++) {
+        if (logs[i])
+            fclose(logs[i]);
+    }
+    for (unsigned j = 0; j < cfg.jobs; j++) {
+        if (results[j])
+            fclose(results[j]);
+    }
+    free(logs);
+    free(results);
+    free(pids);
+    return ret;
+}
+
+#if HAVE_PTHREAD_SETAFFINITY_NP && defined(CPU_SET)
+static cpu_set_t bench_affinity; /* restored by stop_bench_workers() */
+#endif
+
+/* Select the CPUs to run contention benchmarks on, from the affinity mask. The
+ * main process stays on the --affinity CPU, if any */
+static COLD void init_bench_cpus(void)
+{
+#if HAVE_PTHREAD_SETAFFINITY_NP && defined(CPU_SET)
+    cpu_set_t mask;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(mask), &mask))
+        return;
+
+    if (cfg.cpu_affinity_set && cfg.cpu_affinity < CPU_SETSIZE
+        && CPU_ISSET(cfg.cpu_affinity, &mask)) {
+        state.bench_cpus[state.nb_bench_cpus++] = (int) cfg.cpu_affinity;
+        CPU_CLR(cfg.cpu_affinity, &mask);
+    }
+
+    for (int c = 0; c < CPU_SETSIZE && state.nb_bench_cpus < (int) cfg.bench_threads; c++) {
+        if (CPU_ISSET(c, &mask))
+            state.bench_cpus[state.nb_bench_cpus++] = c;
+    }
+
+    if (state.nb_bench_cpus < (int) cfg.bench_threads) {
+        LOG("checkasm: only %d CPUs available for --bench-threads\n",
+            state.nb_bench_cpus);
+        cfg.bench_threads = state.nb_bench_cpus;
+    }
+#endif
+}
+
+static void pin_bench_cpu(const int idx)
+{
+#if HAVE_PTHREAD_SETAFFINITY_NP && defined(CPU_SET)
+    if (!state.nb_bench_cpus)
+        return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(state.bench_cpus[idx], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void) idx;
+#endif
+}
+
+static volatile sig_atomic_t bench_worker_stop;
+
+static void bench_worker_stop_handler(const int sig)
+{
+    (void) sig;
+    bench_worker_stop = 1;
+}
+
+/* Fork (cfg.bench_threads - 1) worker processes, each pinned to its own CPU,
+ * which continue running the benchmark loop of the current function from the
+ * same point, until stopped. This returns inside the workers as well, which
+ * are then trapped in bench_worker_runs() */
+static void start_bench_workers(void)
+{
+    int ready[2], go[2], results[2];
+    if (pipe(results))
+        return;
+    if (pipe(ready)) {
+        close(results[0]);
+        close(results[1]);
+        return;
+    }
+    if (pipe(go)) {
+        close(results[0]);
+        close(results[1]);
+        close(ready[0]);
+        close(ready[1]);
+        return;
+    }
+
+#if HAVE_PTHREAD_SETAFFINITY_NP && defined(CPU_SET)
+    pthread_getaffinity_np(pthread_self(), sizeof(bench_affinity), &bench_affinity);
+#endif
+    pin_bench_cpu(0);
+    fflush(stdout);
+    fflush(stderr);
+
+    for (int i = 1; i < (int) cfg.bench_threads; i++) {
+        const pid_t pid = fork();
+        if (pid < 0)
+            break;
+
+        if (!pid) {
+            checkasm_perf_fork_child();
+            state.bench_worker     = 1;
+            state.nb_bench_workers = 0;
+            state.bench_results    = results[1];
+            state.worker_cycles    = 0;
+            state.worker_iters     = 0;
+            close(results[0]);
+#if HAVE_PRCTL && defined(PR_SET_PDEATHSIG)
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+            signal(SIGUSR1, bench_worker_stop_handler);
+            pin_bench_cpu(i);
+
+            /* Signal readiness, then wait for all workers to start at once */
+            char c = 0;
+            if (write(ready[1], &c, 1) != 1 || read(go[0], &c, 1) != 1)
+                _exit(1);
+            close(ready[0]);
+            close(ready[1]);
+            close(go[0]);
+            close(go[1]);
+            return;
+        }
+
+        state.bench_workers[state.nb_bench_workers++] = pid;
+    }
+
+    /* Only the workers may hold the write end, so a dead one can't block us */
+    close(results[1]);
+    state.bench_results = results[0];
+
+    char buf[MAX_BENCH_THREADS] = { 0 };
+    for (int n = 0; n < state.nb_bench_workers;) {
+        const ssize_t ret = read(ready[0], buf, state.nb_bench_workers - n);
+        if (ret <= 0)
+            break;
+        n += (int) ret;
+    }
+    if (write(go[1], buf, state.nb_bench_workers) != state.nb_bench_workers)
+        stop_bench_workers(NULL);
+
+    close(ready[0]);
+    close(ready[1]);
+    close(go[0]);
+    close(go[1]);
+}
+
+/* Stop all workers, collecting their totals into `results` (if non-NULL) */
+static void stop_bench_workers(CheckasmStats *const results)
+{
+    if (state.bench_worker || !state.nb_bench_workers)
+        return;
+
+    if (results) {
+        checkasm_stats_reset(results);
+        for (int i = 0; i < state.nb_bench_workers; i++)
+            kill(state.bench_workers[i], SIGUSR1);
+
+        /* Reports are atomic, and this ends early if any worker died */
+        CheckasmSample s;
+        for (int n = 0; n < state.nb_bench_workers;) {
+            const ssize_t ret = read(state.bench_results, &s, sizeof(s));
+            if (ret < 0 && errno == EINTR)
+                continue;
+            if (ret != sizeof(s))
+                break;
+            checkasm_stats_add(results, s);
+            n++;
+        }
+    }
+
+    for (int i = 0; i < state.nb_bench_workers; i++) {
+        kill(state.bench_workers[i], SIGKILL);
+        while (waitpid(state.bench_workers[i], NULL, 0) < 0 && errno == EINTR)
+            ;
+    }
+    state.nb_bench_workers = 0;
+    close(state.bench_results);
+
+#if HAVE_PTHREAD_SETAFFINITY_NP && defined(CPU_SET)
+    if (state.nb_bench_cpus)
+        pthread_setaffinity_np(pthread_self(), sizeof(bench_affinity), &bench_affinity);
+#endif
+}
+
+/* Send the totals of this worker to stop_bench_workers(), and exit */
+static NORETURN void bench_worker_exit(void)
+{
+    /* Scaled down to fit a single sample, without changing the time per call */
+    uint64_t sum = state.worker_cycles, count = state.worker_iters;
+    for (; count > 1 << 22; count >>= 1)
+        sum >>= 1;
+
+    const CheckasmSample s = { sum, (int) count };
+    _exit(write(state.bench_results, &s, sizeof(s)) != sizeof(s));
+}
+
+/* Keep the benchmark loop running inside worker processes, until stopped */
+static int bench_worker_runs(void)
+{
+    if (checkasm_interrupted)
+        _exit(0);
+
+    if (stats.nb_samples == CHECKASM_STATS_SAMPLES || bench_worker_stop) {
+        for (int i = 0; i < stats.nb_samples; i++) {
+            state.worker_cycles += stats.samples[i].sum;
+            state.worker_iters += stats.samples[i].count;
+        }
+        const int count = stats.next_count;
+        checkasm_stats_reset(&stats);
+        stats.next_count = count;
+    }
+
+    if (bench_worker_stop)
+        bench_worker_exit();
+    return stats.next_count;
+}
+
+#endif /* HAVE_FORK */
+
 void checkasm_list_functions(const CheckasmConfig *config)
 {
     memset(&state, 0, sizeof(state));
@@ -749,8 +2611,9 @@ void checkasm_list_functions(const CheckasmConfig *config)
 
     run_all_tests();
 
-    print_functions(current.tree.root);
+    print_functions(checkasm_func_tree_sorted(&current.tree));
     checkasm_func_tree_uninit(&current.tree);
+    checkasm_arena_release();
 }
 
 static void cpu_fprintf(void *priv, const char *fmt, ...)
@@ -765,6 +2628,33 @@ static void cpu_fprintf(void *priv, const char *fmt, ...)
     va_end(ap);
 }
 
+static COLD void print_env_info(void)
+{
+    const CheckasmEnvironment *const env = &state.env;
+    const char                      *issues[8];
+    const int                        nb_issues = env_issues(issues);
+
+    LOG(" - Environment: CPU %d", env->cpu);
+    if (env->governor[0])
+        LOG(", %s governor", env->governor);
+    if (env->turbo >= 0)
+        LOG(", turbo %s", env->turbo ? "on" : "off");
+    if (env->isolated > 0)
+        LOG(", isolated");
+    if (env->nohz_full > 0)
+        LOG(", nohz_full");
+    for (int i = 0; i < env->nb_siblings; i++)
+        LOG("%s%d", i ? "," : ", SMT sibling ", env->siblings[i]);
+    if (!isnan(env->sibling_load))
+        LOG(" (%.0f%% busy)", 100.0 * env->sibling_load);
+    LOG(", memory %slocked", env->locked ? "" : "not ");
+    if (env->memlock_limit >= 0)
+        LOG(" (limit %" PRId64 " KiB)", env->memlock_limit >> 10);
+    LOG(", nice %d\n", env->nice);
+    for (int i = 0; i < nb_issues; i++)
+        LOG_COLOR(COLOR_YELLOW, "   warning: %s\n", issues[i]);
+}
+
 static COLD void print_info(void)
 {
     LOG_COLOR(COLOR_YELLOW, "checkasm:\n");
@@ -785,8 +2675,42 @@ static COLD void print_info(void)
                 checkasm_mode(nop_cycles), checkasm_stddev(nop_cycles),
                 checkasm_perf.unit);
         }
-        LOG(" - Bench duration: %d µs per function (%" PRIu64 " %ss)\n", cfg.bench_usec,
-            state.target_cycles, checkasm_perf.unit);
+        if (cfg.bench_precision) {
+            LOG(" - Bench precision: %g%% per function (up to %d µs)\n",
+                cfg.bench_precision, PRECISION_TIME_CAP * cfg.bench_usec);
+        } else {
+            LOG(" - Bench duration: %d µs per function (%" PRIu64 " %ss)\n",
+                cfg.bench_usec, state.target_cycles, checkasm_perf.unit);
+        }
+        if (cfg.cache_state != CHECKASM_CACHE_HOT) {
+            LOG(" - Cache state: %s (%d single calls per function)\n",
+                cache_state_names[cfg.cache_state], COLD_SAMPLES);
+        }
+        if (cfg.bench_paired)
+            LOG(" - Paired: batches alternate with the reference version\n");
+        if (cfg.bench_quantiles)
+            LOG(" - Quantiles: at least %d single calls per function\n", TAIL_SAMPLES);
+        if (cfg.roofline) {
+            const CheckasmRoofline *const roof = &state.roofline;
+            LOG(" - Roofline: %.1f Gop/s peak (%s)", roof->peak_ops, roof->peak_isa);
+            for (int level = CHECKASM_CACHE_HOT; level <= CHECKASM_CACHE_DRAM; level++)
+                LOG(", %.1f GB/s %s", roof->bandwidth[level], cache_state_names[level]);
+            LOG("\n");
+        }
+        if (state.telemetry) {
+            LOG(" - Telemetry: %s (rerun on >%.0f%% clock change)\n",
+                checkasm_telemetry_desc(), 100.0 * CLOCK_TOLERANCE);
+        }
+        if (cfg.stable_env)
+            print_env_info();
+#if HAVE_FORK
+        if (cfg.bench_threads > 1) {
+            LOG(" - Bench threads: %u", cfg.bench_threads);
+            for (int i = 0; i < state.nb_bench_cpus; i++)
+                LOG("%s%d", i ? ", " : " (CPUs ", state.bench_cpus[i]);
+            LOG("%s\n", state.nb_bench_cpus ? ")" : " (unpinned)");
+        }
+#endif
     }
     LOG(" - Random seed: %u\n", cfg.seed);
 }
@@ -840,15 +2764,61 @@ static int print_summary(int interrupted)
     else
         LOG("\n");
 
-    if (current.num_benched && !current.num_failed)
-        print_benchmarks();
+    if (cfg.format == CHECKASM_FORMAT_NDJSON)
+        print_ndjson_footer(interrupted);
+
+    /* With merged results, only the final table is meaningful */
+    const int last_iter = interrupted || state.test_iter + 1 == cfg.repeat;
+    if (current.num_benched && !current.num_failed && (last_iter || !cfg.merge_repeats)) {
+        if (cfg.format != CHECKASM_FORMAT_NDJSON)
+            print_benchmarks();
+        if (cfg.save_baseline && save_baseline())
+            return 1;
+
+        const int regressions = check_baseline(checkasm_func_tree_sorted(&current.tree));
+        if (regressions) {
+            LOG_COLOR(COLOR_RED, "checkasm: %d benchmarks regressed by more than %g%%\n",
+                      regressions, cfg.regression_threshold);
+            return 1;
+        }
+    }
 
     return current.num_failed > 0;
 }
 
+/* Reset the state for the next --repeat iteration */
+static void next_iteration(void)
+{
+    if (!cfg.merge_repeats) {
+        checkasm_func_tree_uninit(&current.tree);
+        memset(&current, 0, sizeof(current));
+    } else {
+        /* Keep accumulating into the same functions and benchmark totals */
+        const CheckasmFuncTree tree        = current.tree;
+        const int              report_idx  = current.report_idx;
+        const int              num_benched = current.num_benched;
+        const double           var_sum     = current.var_sum;
+        const double           var_max     = current.var_max;
+
+        memset(&current, 0, sizeof(current));
+        current.tree        = tree;
+        current.report_idx  = report_idx;
+        current.num_benched = num_benched;
+        current.var_sum     = var_sum;
+        current.var_max     = var_max;
+    }
+
+    /* Not sampled yet, rather than a reading of 0 °C */
+    current.telemetry_start = current.telemetry_end = no_telemetry;
+}
+
 static void handle_interrupt(void)
 {
     if (checkasm_interrupted) {
+#if HAVE_FORK
+        if (state.child_results)
+            child_exit(128 + checkasm_interrupted);
+#endif
         print_summary(1);
         exit(128 + checkasm_interrupted);
     }
@@ -866,8 +2836,14 @@ int checkasm_run(const CheckasmConfig *config)
     memset(&state, 0, sizeof(state));
     memset(&current, 0, sizeof(current));
     cfg = *config;
+    checkasm_exact_init = cfg.exact_init;
 
     checkasm_set_signal_handlers();
+#if HAVE_FORK
+    /* Before restricting our own affinity mask */
+    if (cfg.bench && cfg.bench_threads > 1)
+        init_bench_cpus();
+#endif
 #if HAVE_PRCTL && defined(PR_SET_UNALIGN)
     prctl(PR_SET_UNALIGN, PR_UNALIGN_SIGBUS);
 #endif
@@ -875,21 +2851,78 @@ int checkasm_run(const CheckasmConfig *config)
         set_cpu_affinity(cfg.cpu_affinity);
     checkasm_setup_fprintf();
 
-    if (!cfg.seed && !cfg.seed_set)
+    const int random_seed = !cfg.seed && !cfg.seed_set;
+    if (random_seed)
         cfg.seed = checkasm_seed();
     if (!cfg.repeat)
         cfg.repeat = 1;
     if (!cfg.bench_usec)
         cfg.bench_usec = 1000;
+    if (!cfg.regression_threshold && !cfg.regression_threshold_set)
+        cfg.regression_threshold = 5.0;
+    if (!cfg.telemetry_root)
+        cfg.telemetry_root = "/sys";
+    if (cfg.resume && !cfg.checkpoint_file) {
+        LOG("checkasm: --resume requires --checkpoint\n");
+        return 1;
+    }
+    if (cfg.jobs > 1 && cfg.bench) {
+        LOG("checkasm: ignoring --jobs while benchmarking\n");
+        cfg.jobs = 1;
+    }
+#if !HAVE_FORK
+    if (cfg.bench_threads > 1) {
+        LOG("checkasm: --bench-threads is not supported on your system\n");
+        cfg.bench_threads = 0;
+    }
+    if (cfg.jobs > 1) {
+        LOG("checkasm: --jobs is not supported on your system\n");
+        cfg.jobs = 1;
+    }
+    if (cfg.isolate) {
+        LOG("checkasm: --isolate is not supported on your system\n");
+        cfg.isolate = 0;
+    }
+#endif
+    if (cfg.merge_repeats && (cfg.jobs > 1 || cfg.isolate)) {
+        LOG("checkasm: ignoring --merge-repeats with --jobs or --isolate\n");
+        cfg.merge_repeats = 0;
+    }
+    if (cfg.merge_repeats && cfg.checkpoint_file) {
+        LOG("checkasm: ignoring --checkpoint with --merge-repeats\n");
+        cfg.checkpoint_file = NULL;
+        cfg.resume          = 0;
+    }
 
     if (cfg.bench) {
+        /* Before any calibration, so that it runs under the same conditions */
+        if (cfg.stable_env) {
+            const int cpu = cfg.cpu_affinity_set ? (int) cfg.cpu_affinity : -1;
+            checkasm_env_check(&state.env, cfg.telemetry_root, cpu);
+            checkasm_env_harden(&state.env);
+        }
+
         if (checkasm_perf_init())
             return 1;
+        if (cfg.perf_counters)
+            checkasm_perf_init_counters();
 
         checkasm_stats_reset(&stats);
         checkasm_measurement_init(&state.nop_cycles);
+        checkasm_measurement_init(&state.nop_cycles_single);
+        checkasm_measurement_init(&state.nop_cycles_serial);
         checkasm_measurement_init(&state.perf_scale);
         checkasm_measure_perf_scale(&state.perf_scale);
+        if (cfg.roofline)
+            checkasm_measure_roofline(&state.roofline);
+        if (cfg.telemetry) {
+            state.telemetry = !checkasm_telemetry_init(cfg.telemetry_root);
+            if (!state.telemetry) {
+                LOG("checkasm: no cpufreq or thermal data found in %s\n",
+                    cfg.telemetry_root);
+            }
+            current.telemetry_start = current.telemetry_end = no_telemetry;
+        }
 
         /* Use the low estimate to compute the number of target cycles, to
          * ensure we reach the required number of cycles with confidence */
@@ -905,24 +2938,69 @@ int checkasm_run(const CheckasmConfig *config)
 
         state.target_cycles = (uint64_t) (1e3 * cfg.bench_usec / low_estimate);
         checkasm_measure_nop_cycles(&state.nop_cycles, state.target_cycles);
+        if (cfg.cache_state != CHECKASM_CACHE_HOT || cfg.bench_quantiles)
+            checkasm_measure_nop_cycles_single(&state.nop_cycles_single);
+        if (cfg.bench_latency)
+            checkasm_measure_nop_cycles_serial(&state.nop_cycles_serial,
+                                               state.target_cycles);
     }
 
     checkasm_init_cpu();
 
+    if (cfg.bench && cfg.compare_baseline && load_baseline())
+        return 1;
+
+    if (cfg.bench && cfg.checkpoint_file && open_checkpoint(random_seed))
+        return 1;
+
+    if (cfg.bench && cfg.trace_file) {
+        const CheckasmVar perf_scale = checkasm_measurement_result(state.perf_scale);
+        if (checkasm_trace_open(cfg.trace_file, checkasm_perf.unit,
+                                checkasm_mode(perf_scale)))
+            return 1;
+    }
+
     print_info();
 
     for (state.test_iter = 0; state.test_iter < cfg.repeat; state.test_iter++) {
-        run_all_tests();
+        if (cfg.format == CHECKASM_FORMAT_NDJSON)
+            print_ndjson_header();
+#if HAVE_FORK
+        if (cfg.jobs > 1) {
+            if (run_parallel())
+                return 1;
+            handle_interrupt();
+        } else if (cfg.isolate) {
+            for (const CheckasmTest *test = cfg.tests; test->func; test++) {
+                if (test_enabled(test))
+                    run_test_isolated(test);
+            }
+            handle_interrupt();
+        } else
+#endif
+            run_all_tests();
 
         int res = print_summary(0);
-        checkasm_func_tree_uninit(&current.tree);
-        if (res)
+        if (res) {
+            checkasm_func_tree_uninit(&current.tree);
+            checkasm_baseline_uninit(&state.baseline);
+            checkasm_checkpoint_close(&state.checkpoint);
+            checkasm_evict_cache_uninit();
+            checkasm_arena_release();
+            checkasm_trace_close();
             return res;
+        }
 
-        memset(&current, 0, sizeof(current));
+        next_iteration();
         cfg.seed++;
     }
 
+    checkasm_func_tree_uninit(&current.tree);
+    checkasm_baseline_uninit(&state.baseline);
+    checkasm_checkpoint_close(&state.checkpoint);
+    checkasm_evict_cache_uninit();
+    checkasm_arena_release();
+    checkasm_trace_close();
     return 0;
 }
 
@@ -937,22 +3015,29 @@ CheckasmKey checkasm_check_key(const CheckasmKey version, const char *const name
     if (checkasm_interrupted)
         goto skip;
 
-    va_start(arg, name);
-    int name_length = vsnprintf(name_buf, sizeof(name_buf), name, arg);
-    va_end(arg);
+    /* Skip formatting names without any conversion specifiers */
+    const char *func_name   = name;
+    int         name_length = (int) strcspn(name, "%");
+    if (name[name_length]) {
+        va_start(arg, name);
+        name_length = vsnprintf(name_buf, sizeof(name_buf), name, arg);
+        va_end(arg);
+        func_name = name_buf;
+    }
 
     if (!version || name_length <= 0 || (size_t) name_length >= sizeof(name_buf)
-        || (cfg.function_pattern && wildstrcmp(name_buf, cfg.function_pattern)))
+        || (cfg.function_pattern && wildstrcmp(func_name, cfg.function_pattern)))
         goto skip;
 
-    CheckasmFunc *const  f   = checkasm_func_get(&current.tree, name_buf);
-    CheckasmFuncVersion *v   = &f->versions;
-    CheckasmKey          ref = version;
+    CheckasmFunc *const  f      = checkasm_func_get(&current.tree, func_name);
+    CheckasmFuncVersion *v      = &f->versions;
+    CheckasmKey          ref    = version;
+    int                  retest = 0;
 
     if (v->key) {
         CheckasmFuncVersion *prev;
         do {
-            if (v->state == CHECKASM_FUNC_CRASHED) {
+            if (v->state == CHECKASM_FUNC_CRASHED && v->iter == state.test_iter) {
                 /* This function threw a signal last time; so restore the
                  * retained test state for the next report() call */
                 v->state = CHECKASM_FUNC_FAILED;
@@ -967,12 +3052,17 @@ CheckasmKey checkasm_check_key(const CheckasmKey version, const char *const name
             }
 
             /* Skip functions without a working reference */
-            if (!v->cpu && v->state != CHECKASM_FUNC_OK)
+            if (!v->cpu && v->state != CHECKASM_FUNC_OK && v->iter == state.test_iter)
                 goto skip;
 
-            /* Only test functions that haven't already been tested */
-            if (v->key == version)
-                goto skip;
+            /* Only test functions that haven't already been tested, except
+             * for versions kept from previous iterations (cfg.merge_repeats) */
+            if (v->key == version) {
+                if (v->iter == state.test_iter)
+                    goto skip;
+                retest = 1;
+                break;
+            }
 
             /* Exclude failed or variant functions from being used as ref */
             if (v->state == CHECKASM_FUNC_OK && !v->suffix)
@@ -981,11 +3071,14 @@ CheckasmKey checkasm_check_key(const CheckasmKey version, const char *const name
             prev = v;
         } while ((v = v->next));
 
-        v = prev->next = checkasm_mallocz(sizeof(CheckasmFuncVersion));
+        if (!retest)
+            v = prev->next = checkasm_func_version_alloc(&current.tree);
     }
 
     if (current.func_variant) {
-        v->suffix = current.func_variant;
+        if (!v->suffix)
+            v->suffix = checkasm_arena_strdup(&current.tree.arena, current.func_variant);
+        free(current.func_variant);
         current.func_variant = NULL;
         name_length += (int) strlen(v->suffix) + 1;
     } else {
@@ -998,6 +3091,7 @@ CheckasmKey checkasm_check_key(const CheckasmKey version, const char *const name
     v->key   = version;
     v->state = CHECKASM_FUNC_OK;
     v->cpu   = current.cpu;
+    v->iter  = state.test_iter;
     if (ref == version)
         current.num_funcs++;
 
@@ -1022,9 +3116,31 @@ CheckasmKey checkasm_check_key(const CheckasmKey version, const char *const name
 #if ARCH_X86
         checkasm_simd_warmup();
 #endif
-        checkasm_measurement_init(&v->cycles);
+        if (retest) {
+            /* Accumulate the results of this iteration with the previous ones */
+            checkasm_measurement_iterate(&v->cycles);
+            checkasm_measurement_iterate(&v->threaded_cycles);
+            checkasm_measurement_iterate(&v->worker_cycles);
+            checkasm_measurement_iterate(&v->latency);
+            checkasm_measurement_iterate(&v->cold_cycles);
+            v->streamed = 0;
+        } else {
+            checkasm_measurement_init(&v->cycles);
+            checkasm_measurement_init(&v->threaded_cycles);
+            checkasm_measurement_init(&v->worker_cycles);
+            checkasm_measurement_init(&v->latency);
+            checkasm_measurement_init(&v->cold_cycles);
+            v->work      = (CheckasmWork) { 0 };
+            v->telemetry = (CheckasmTelemetry) { 0 };
+            v->paired    = (CheckasmPaired) { 0 };
+            v->rejects   = (CheckasmRejects) { 0 };
+            v->quantiles = NULL;
+        }
+        current.resumed = cfg.checkpoint_file && restore_checkpoint(v);
     }
 
+    current.work_bytes = current.work_elems = current.work_ops = 0;
+    current.rejects    = (CheckasmRejects) { 0 }; /* from measuring the overhead */
     return ref;
 
 skip:
@@ -1042,6 +3158,17 @@ void checkasm_set_func_variant(const char *id_fmt, ...)
     va_end(arg);
 }
 
+void checkasm_bench_set_work(const uint64_t bytes, const uint64_t elements)
+{
+    current.work_bytes = bytes;
+    current.work_elems = elements;
+}
+
+void checkasm_bench_set_ops(const uint64_t ops)
+{
+    current.work_ops = ops;
+}
+
 /* Indicate that the current test has failed, return whether verbose printing
  * is requested. */
 static int fail_internal(const char *const msg, va_list arg)
@@ -1153,10 +3280,16 @@ void checkasm_report(const char *const name, ...)
     CheckasmFunc *func = current.func;
     while (func) {
         if (name && !func->report_name)
-            func->report_name = checkasm_strdup(report_name);
+            func->report_name = checkasm_arena_strdup(&current.tree.arena, report_name);
         func = func->prev;
     }
 
+    /* All versions in this report group are final once it has been reported */
+    if (state.checkpoint.file)
+        save_checkpoint(current.func);
+    if (cfg.format == CHECKASM_FORMAT_NDJSON && cfg.bench)
+        print_ndjson_results(current.func);
+
     current.func = NULL; /* reset current function for new report */
     current.report_idx++;
     handle_interrupt();
@@ -1170,18 +3303,56 @@ static void print_usage(const char *const progname)
             "Options:\n"
             "    --affinity=<cpu>           Run the process on CPU <cpu>\n"
             "    --bench -b                 Benchmark the tested functions\n"
+            "    --bench-threads=<N>        Also benchmark with N concurrent copies, "
+            "on\n"
+            "                               separate cores\n"
+            "    --compare=<file>           Compare benchmarks against a saved baseline\n"
+            "    --cache-state=<level>      Also benchmark with caches evicted down to\n"
+            "                               <level> (one of: l1, l2, llc, dram)\n"
+            "    --checkpoint=<file>        Save finished benchmark results to <file>\n"
+            "    --counters                 Also record hardware performance counters\n"
             "    --csv, --tsv, --json,      Choose output format for benchmarks\n"
-            "    --html\n"
+            "    --html, --ndjson\n"
+            "    --exact-init               Generate the same checkasm_init() data as "
+            "before v1.4.0\n"
             "    --function=<pattern> -f    Test only the functions matching "
             "<pattern>\n"
             "    --help -h                  Print this usage info\n"
+            "    --isolate                  Run each test in a separate process\n"
+            "    --jobs[=<N>] -j            Run tests in N worker processes "
+            "(default: all cores)\n"
+            "    --latency                  Also benchmark the latency of all functions\n"
             "    --list-cpu-flags           List available cpu flags\n"
             "    --list-functions           List available functions\n"
             "    --list-tests               List available tests\n"
+            "    --merge-repeats            Combine the benchmarks of all --repeat "
+            "iterations\n"
             "    --duration=<μs>            Benchmark duration (per function) in "
             "μs\n"
+            "    --outliers=<method>        Outlier rejection for benchmarks (one of:\n"
+            "                               ratio (default), none, mad, trim)\n"
+            "    --paired                   Benchmark optimized versions interleaved "
+            "with the\n"
+            "                               reference, for a more precise speedup\n"
+            "    --precision=<percent>      Benchmark each function until the relative "
+            "error\n"
+            "                               is below this (up to 10x --duration)\n"
+            "    --quantiles                Also record the per-call latency distribution\n"
             "    --repeat[=<N>]             Repeat tests N times, on successive seeds\n"
+            "    --resume                   Skip benchmarks already saved by --checkpoint\n"
+            "    --roofline                 Measure the machine's bandwidth and peak "
+            "throughput,\n"
+            "                               and report each function's efficiency\n"
+            "    --save-baseline=<file>     Save benchmark results as a baseline\n"
+            "    --stable-env               Check the CPU frequency, isolation and SMT "
+            "setup,\n"
+            "                               lock memory and raise the priority\n"
+            "    --telemetry[=<root>]       Record clock frequency and temperature from "
+            "sysfs,\n"
+            "                               and rerun measurements during clock changes\n"
             "    --test=<pattern> -t        Test only <pattern>\n"
+            "    --threshold=<percent>      Maximum slowdown vs baseline (default: 5)\n"
+            "    --trace=<file>             Write all raw benchmark samples to <file>\n"
             "    --verbose -v               Print verbose timing info and failure "
             "data\n",
             progname);
@@ -1233,6 +3404,8 @@ int checkasm_main(CheckasmConfig *config, int argc, const char *argv[])
             config->format = CHECKASM_FORMAT_TSV;
         } else if (!strcmp(argv[1], "--json")) {
             config->format = CHECKASM_FORMAT_JSON;
+        } else if (!strcmp(argv[1], "--ndjson")) {
+            config->format = CHECKASM_FORMAT_NDJSON;
         } else if (!strcmp(argv[1], "--html")) {
 #if HAVE_HTML_DATA
             config->format = CHECKASM_FORMAT_HTML;
@@ -1261,6 +3434,90 @@ int checkasm_main(CheckasmConfig *config, int argc, const char *argv[])
             argv++;
         } else if (!strcmp(argv[1], "--verbose") || !strcmp(argv[1], "-v")) {
             config->verbose = 1;
+        } else if (!strncmp(argv[1], "--save-baseline=", 16)) {
+            config->save_baseline = argv[1] + 16;
+        } else if (!strncmp(argv[1], "--compare=", 10)) {
+            config->compare_baseline = argv[1] + 10;
+        } else if (!strncmp(argv[1], "--precision=", 12)) {
+            const char *const s = argv[1] + 12;
+            char             *end;
+            config->bench_precision = strtod(s, &end);
+            if (end == s || *end || config->bench_precision <= 0.0) {
+                LOG("checkasm: invalid benchmark precision (%s)\n", s);
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (!strncmp(argv[1], "--threshold=", 12)) {
+            const char *const s = argv[1] + 12;
+            char             *end;
+            config->regression_threshold = strtod(s, &end);
+            if (end == s || *end || config->regression_threshold < 0.0) {
+                LOG("checkasm: invalid regression threshold (%s)\n", s);
+                print_usage(argv[0]);
+                return 1;
+            }
+            config->regression_threshold_set = 1;
+        } else if (!strncmp(argv[1], "--cache-state=", 14)) {
+            const char *const s = argv[1] + 14;
+            const int         n = ARRAY_SIZE(cache_state_names);
+            int               i = 0;
+            while (i < n && strcmp(s, cache_state_names[i]))
+                i++;
+            if (i == n) {
+                LOG("checkasm: invalid cache state (%s)\n", s);
+                print_usage(argv[0]);
+                return 1;
+            }
+            config->cache_state = (CheckasmCacheState) i;
+        } else if (!strncmp(argv[1], "--trace=", 8)) {
+            config->trace_file = argv[1] + 8;
+        } else if (!strncmp(argv[1], "--checkpoint=", 13)) {
+            config->checkpoint_file = argv[1] + 13;
+        } else if (!strcmp(argv[1], "--resume")) {
+            config->resume = 1;
+        } else if (!strcmp(argv[1], "--merge-repeats")) {
+            config->merge_repeats = 1;
+        } else if (!strcmp(argv[1], "--exact-init")) {
+            config->exact_init = 1;
+        } else if (!strncmp(argv[1], "--outliers=", 11)) {
+            const char *const s = argv[1] + 11;
+            const int         n = ARRAY_SIZE(outlier_names);
+            int               i = 0;
+            while (i < n && strcmp(s, outlier_names[i]))
+                i++;
+            if (i == n) {
+                LOG("checkasm: invalid outlier rejection method (%s)\n", s);
+                print_usage(argv[0]);
+                return 1;
+            }
+            config->outliers = (CheckasmOutliers) i;
+        } else if (!strncmp(argv[1], "--bench-threads=", 16)) {
+            const char *const s = argv[1] + 16;
+            if (!parseu(&config->bench_threads, s, 10) || !config->bench_threads
+                || config->bench_threads > MAX_BENCH_THREADS) {
+                LOG("checkasm: invalid number of bench threads (%s)\n", s);
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (!strcmp(argv[1], "--latency")) {
+            config->bench_latency = 1;
+        } else if (!strcmp(argv[1], "--paired")) {
+            config->bench_paired = 1;
+        } else if (!strcmp(argv[1], "--quantiles")) {
+            config->bench_quantiles = 1;
+        } else if (!strcmp(argv[1], "--roofline")) {
+            config->roofline = 1;
+        } else if (!strcmp(argv[1], "--stable-env")) {
+            config->stable_env = 1;
+        } else if (!strncmp(argv[1], "--telemetry=", 12)) {
+            config->telemetry      = 1;
+            config->telemetry_root = argv[1] + 12;
+        } else if (!strcmp(argv[1], "--telemetry")) {
+            config->telemetry = 1;
+        } else if (!strcmp(argv[1], "--counters")) {
+            config->perf_counters = 1;
+        } else if (!strcmp(argv[1], "--isolate")) {
+            config->isolate = 1;
         } else if (!strncmp(argv[1], "--affinity=", 11)) {
             const char *const s      = argv[1] + 11;
             config->cpu_affinity_set = 1;
@@ -1278,6 +3535,20 @@ int checkasm_main(CheckasmConfig *config, int argc, const char *argv[])
             }
         } else if (!strcmp(argv[1], "--repeat")) {
             config->repeat = UINT_MAX;
+        } else if (!strncmp(argv[1], "--jobs=", 7)) {
+            const char *const s = argv[1] + 7;
+            if (!parseu(&config->jobs, s, 10)) {
+                LOG("checkasm: invalid number of jobs (%s)\n", s);
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (!strcmp(argv[1], "--jobs") || !strcmp(argv[1], "-j")) {
+#if HAVE_FORK && defined(_SC_NPROCESSORS_ONLN)
+            const long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+            config->jobs     = ncpus > 0 ? (unsigned) ncpus : 1;
+#else
+            config->jobs = 1;
+#endif
         } else {
             config->seed_set = 1;
             if (!parseu(&config->seed, argv[1], 10)) {
@@ -136,6 +136,16 @@
   #endif
 #endif
 
+#ifndef HAVE_FSYNC
+  #if defined(__linux__) || defined(__APPLE__) || defined(__DragonFly__)                 \
+      || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)             \
+      || defined(__unix__)
+    #define HAVE_FSYNC 1
+  #else
+    #define HAVE_FSYNC 0
+  #endif
+#endif
+
 #ifndef HAVE_SIGACTION
   #if defined(__linux__) || defined(__APPLE__) || defined(__DragonFly__)                 \
       || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)             \
@@ -156,6 +166,34 @@
   #endif
 #endif
 
+#ifndef HAVE_MPROTECT
+  #if defined(__linux__) || defined(__APPLE__) || defined(__DragonFly__)                 \
+      || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)             \
+      || defined(__unix__)
+    #define HAVE_MPROTECT 1
+  #else
+    #define HAVE_MPROTECT 0
+  #endif
+#endif
+
+#ifndef HAVE_MLOCKALL
+  #if defined(__linux__) || defined(__DragonFly__) || defined(__FreeBSD__)               \
+      || defined(__OpenBSD__) || defined(__NetBSD__)
+    #define HAVE_MLOCKALL 1
+  #else
+    #define HAVE_MLOCKALL 0
+  #endif
+#endif
+
+#ifndef HAVE_SETPRIORITY
+  #if defined(__linux__) || defined(__APPLE__) || defined(__DragonFly__)                 \
+      || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+    #define HAVE_SETPRIORITY 1
+  #else
+    #define HAVE_SETPRIORITY 0
+  #endif
+#endif
+
 #ifndef HAVE_STDBIT_H
   #if __has_include(<stdbit.h>)
     #define HAVE_STDBIT_H 1
@@ -199,6 +237,24 @@
   #endif
 #endif
 
+#ifndef HAVE_SCHED_GETCPU
+  #if defined(__linux__)
+    /* Since glibc 2.6 (2007) */
+    #define HAVE_SCHED_GETCPU 1
+  #else
+    #define HAVE_SCHED_GETCPU 0
+  #endif
+#endif
+
+#ifndef HAVE_FORK
+  #if defined(__linux__) || defined(__APPLE__) || defined(__DragonFly__)                 \
+      || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+    #define HAVE_FORK 1
+  #else
+    #define HAVE_FORK 0
+  #endif
+#endif
+
 #ifndef PREFIX
   /* This one is different; this one is defined/undefined, not defined to
    * 0/1. */
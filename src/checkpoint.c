@@ -0,0 +1,366 @@
+/*
+ * Copyright © 2025, Niklas Haas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "checkasm_config.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if HAVE_FSYNC
+  #include <unistd.h>
+#endif
+
+#include "checkpoint.h"
+#include "internal.h"
+
+/* Bumped whenever the file format changes incompatibly */
+#define CHECKPOINT_MAGIC   "CHKASMCP"
+#define CHECKPOINT_VERSION 2
+
+typedef struct CheckpointHeader {
+    char     magic[8]; /* CHECKPOINT_MAGIC, not terminated */
+    uint32_t version;
+    uint32_t entry_size;      /* sizeof(SerializedEntry), differs between builds */
+    uint32_t seed;            /* of the first run writing to this file */
+    uint32_t fingerprint_len; /* including the terminating NUL */
+} CheckpointHeader;
+
+/* Followed by the NUL-terminated names, and the histogram if present */
+typedef struct SerializedEntry {
+    uint32_t            seed;
+    uint32_t            test_len, name_len, suffix_len; /* including the NUL */
+    uint32_t            has_quantiles;
+    CheckasmMeasurement cycles;
+    CheckasmMeasurement threaded_cycles;
+    CheckasmMeasurement worker_cycles;
+    CheckasmMeasurement latency;
+    CheckasmMeasurement cold_cycles;
+    CheckasmCounters    counters;
+    CheckasmRejects     rejects;
+    CheckasmWork        work;
+    CheckasmTelemetry   telemetry;
+    CheckasmPaired      paired;
+} SerializedEntry;
+
+static void entry_uninit(CheckasmCheckpointEntry *const e)
+{
+    free(e->test);
+    free(e->name);
+    free(e->suffix);
+    free(e->quantiles);
+}
+
+static void checkpoint_uninit(CheckasmCheckpoint *const cp)
+{
+    for (int i = 0; i < cp->nb_entries; i++)
+        entry_uninit(&cp->entries[i]);
+    free(cp->entries);
+    cp->entries    = NULL;
+    cp->nb_entries = cp->size = 0;
+}
+
+static int cmp_entries(const void *a, const void *b)
+{
+    const CheckasmCheckpointEntry *ea = a, *eb = b;
+    int cmp = strcmp(ea->name, eb->name);
+    if (!cmp)
+        cmp = strcmp(ea->suffix, eb->suffix);
+    if (!cmp)
+        cmp = strcmp(ea->test, eb->test);
+    return cmp ? cmp : (ea->seed > eb->seed) - (ea->seed < eb->seed);
+}
+
+static int write_entry(FILE *const f, const CheckasmCheckpointEntry *const e)
+{
+    const SerializedEntry se = {
+        .seed            = e->seed,
+        .test_len        = (uint32_t) strlen(e->test) + 1,
+        .name_len        = (uint32_t) strlen(e->name) + 1,
+        .suffix_len      = (uint32_t) strlen(e->suffix) + 1,
+        .has_quantiles   = !!e->quantiles,
+        .cycles          = e->cycles,
+        .threaded_cycles = e->threaded_cycles,
+        .worker_cycles   = e->worker_cycles,
+        .latency         = e->latency,
+        .cold_cycles     = e->cold_cycles,
+        .counters        = e->counters,
+        .rejects         = e->rejects,
+        .work            = e->work,
+        .telemetry       = e->telemetry,
+        .paired          = e->paired,
+    };
+
+    return fwrite(&se, sizeof(se), 1, f) != 1
+        || fwrite(e->test, 1, se.test_len, f) != se.test_len
+        || fwrite(e->name, 1, se.name_len, f) != se.name_len
+        || fwrite(e->suffix, 1, se.suffix_len, f) != se.suffix_len
+        || (e->quantiles && fwrite(e->quantiles, sizeof(*e->quantiles), 1, f) != 1);
+}
+
+static char *read_name(FILE *const f, const uint32_t len)
+{
+    if (!len || len > 4096)
+        return NULL;
+
+    char *const str = checkasm_mallocz(len);
+    if (fread(str, 1, len, f) != len || str[len - 1]) {
+        free(str);
+        return NULL;
+    }
+    return str;
+}
+
+/* Returns 0 at the end of the file, including a truncated last entry */
+static int read_entry(FILE *const f, CheckasmCheckpointEntry *const e)
+{
+    SerializedEntry se;
+    if (fread(&se, sizeof(se), 1, f) != 1)
+        return 0;
+
+    *e = (CheckasmCheckpointEntry) {
+        .test            = read_name(f, se.test_len),
+        .name            = read_name(f, se.name_len),
+        .suffix          = read_name(f, se.suffix_len),
+        .seed            = se.seed,
+        .cycles          = se.cycles,
+        .threaded_cycles = se.threaded_cycles,
+        .worker_cycles   = se.worker_cycles,
+        .latency         = se.latency,
+        .cold_cycles     = se.cold_cycles,
+        .counters        = se.counters,
+        .rejects         = se.rejects,
+        .work            = se.work,
+        .telemetry       = se.telemetry,
+        .paired          = se.paired,
+    };
+
+    if (!e->test || !e->name || !e->suffix)
+        goto fail;
+
+    if (se.has_quantiles) {
+        e->quantiles = checkasm_mallocz(sizeof(*e->quantiles));
+        if (fread(e->quantiles, sizeof(*e->quantiles), 1, f) != 1)
+            goto fail;
+    }
+    return 1;
+
+fail:
+    entry_uninit(e);
+    return 0;
+}
+
+static int read_checkpoint(CheckasmCheckpoint *const cp, FILE *const f,
+                           const char *const fingerprint)
+{
+    CheckpointHeader hdr;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1
+        || memcmp(hdr.magic, CHECKPOINT_MAGIC, sizeof(hdr.magic))) {
+        fprintf(stderr, "checkasm: %s: invalid checkpoint file\n", cp->path);
+        return 1;
+    }
+
+    if (hdr.version != CHECKPOINT_VERSION || hdr.entry_size != sizeof(SerializedEntry)) {
+        fprintf(stderr,
+                "checkasm: %s: checkpoint was written by a different build of "
+                "checkasm\n",
+                cp->path);
+        return 1;
+    }
+
+    cp->seed = hdr.seed;
+
+    char *const fp = read_name(f, hdr.fingerprint_len);
+    if (!fp || strcmp(fp, fingerprint)) {
+        fprintf(stderr, "checkasm: %s: checkpoint was recorded on a different system",
+                cp->path);
+        fprintf(stderr, fp ? " (%s)\n" : "\n", fp);
+        free(fp);
+        return 1;
+    }
+    free(fp);
+
+    CheckasmCheckpointEntry e;
+    while (read_entry(f, &e)) {
+        if (cp->nb_entries == cp->size) {
+            cp->size    = cp->size ? 2 * cp->size : 64;
+            cp->entries = checkasm_handle_oom(
+                realloc(cp->entries, cp->size * sizeof(*cp->entries)));
+        }
+        cp->entries[cp->nb_entries++] = e;
+    }
+
+    qsort(cp->entries, cp->nb_entries, sizeof(*cp->entries), cmp_entries);
+    return 0;
+}
+
+int checkasm_checkpoint_open(CheckasmCheckpoint *const cp, const char *const path,
+                             const char *const fingerprint, const unsigned seed,
+                             const int resume)
+{
+    memset(cp, 0, sizeof(*cp));
+    cp->path = path;
+    cp->seed = seed;
+
+    FILE *f;
+    if (resume && (f = fopen(path, "rb"))) {
+        const int ret = read_checkpoint(cp, f, fingerprint);
+        fclose(f);
+        if (ret) {
+            checkpoint_uninit(cp);
+            return 1;
+        }
+    } else if (resume && errno != ENOENT) {
+        fprintf(stderr, "checkasm: failed to open %s: %s\n", path, strerror(errno));
+        return 1;
+    } else if (!resume && (f = fopen(path, "rb"))) {
+        /* Never throw away the results of an earlier (possibly long) run */
+        fclose(f);
+        fprintf(stderr,
+                "checkasm: %s already exists, pass --resume to continue it or "
+                "remove it first\n",
+                path);
+        return 1;
+    }
+
+    /* Rewrite all valid entries, to get rid of any trailing garbage */
+    CheckpointHeader hdr = {
+        .version         = CHECKPOINT_VERSION,
+        .entry_size      = sizeof(SerializedEntry),
+        .seed            = cp->seed,
+        .fingerprint_len = (uint32_t) strlen(fingerprint) + 1,
+    };
+    memcpy(hdr.magic, CHECKPOINT_MAGIC, sizeof(hdr.magic));
+
+    if (!(f = fopen(path, "wb"))) {
+        fprintf(stderr, "checkasm: failed to open %s: %s\n", path, strerror(errno));
+        checkpoint_uninit(cp);
+        return 1;
+    }
+
+    int err = fwrite(&hdr, sizeof(hdr), 1, f) != 1
+           || fwrite(fingerprint, 1, hdr.fingerprint_len, f) != hdr.fingerprint_len;
+    for (int i = 0; !err && i < cp->nb_entries; i++)
+        err = write_entry(f, &cp->entries[i]);
+    if (fclose(f) || err) {
+        fprintf(stderr, "checkasm: failed to write %s: %s\n", path, strerror(errno));
+        checkpoint_uninit(cp);
+        return 1;
+    }
+
+    /* Reopen in append mode, so that entries written by forked processes are
+     * never written on top of each other */
+    if (!(cp->file = fopen(path, "ab"))) {
+        fprintf(stderr, "checkasm: failed to open %s: %s\n", path, strerror(errno));
+        checkpoint_uninit(cp);
+        return 1;
+    }
+
+    return 0;
+}
+
+void checkasm_checkpoint_close(CheckasmCheckpoint *const cp)
+{
+    if (cp->file)
+        fclose(cp->file);
+    checkpoint_uninit(cp);
+    memset(cp, 0, sizeof(*cp));
+}
+
+int checkasm_checkpoint_add(CheckasmCheckpoint *const cp, const char *const test,
+                            const char *const name, const char *const suffix,
+                            const unsigned seed, const CheckasmFuncVersion *const v)
+{
+    const CheckasmCheckpointEntry e = {
+        .test            = (char *) test,
+        .name            = (char *) name,
+        .suffix          = (char *) suffix,
+        .seed            = seed,
+        .cycles          = v->cycles,
+        .threaded_cycles = v->threaded_cycles,
+        .worker_cycles   = v->worker_cycles,
+        .latency         = v->latency,
+        .cold_cycles     = v->cold_cycles,
+        .quantiles       = v->quantiles,
+        .counters        = v->counters,
+        .rejects         = v->rejects,
+        .work            = v->work,
+        .telemetry       = v->telemetry,
+        .paired          = v->paired,
+    };
+
+    /* Make sure the entry survives a crash or power loss right after this */
+    if (write_entry(cp->file, &e) || fflush(cp->file)
+#if HAVE_FSYNC
+        || fsync(fileno(cp->file))
+#endif
+    ) {
+        fprintf(stderr, "checkasm: failed to write %s: %s\n", cp->path, strerror(errno));
+        return 1;
+    }
+
+    return 0;
+}
+
+int checkasm_checkpoint_restore(const CheckasmCheckpoint *const cp,
+                                const char *const test, const char *const name,
+                                const char *const suffix, const unsigned seed,
+                                CheckasmFuncVersion *const v, CheckasmArena *const arena)
+{
+    if (!cp->nb_entries)
+        return 0;
+
+    const CheckasmCheckpointEntry key = {
+        .test   = (char *) test,
+        .name   = (char *) name,
+        .suffix = (char *) suffix,
+        .seed   = seed,
+    };
+
+    const CheckasmCheckpointEntry *const e = bsearch(
+        &key, cp->entries, cp->nb_entries, sizeof(*cp->entries), cmp_entries);
+    if (!e)
+        return 0;
+
+    v->cycles          = e->cycles;
+    v->threaded_cycles = e->threaded_cycles;
+    v->worker_cycles   = e->worker_cycles;
+    v->latency         = e->latency;
+    v->cold_cycles     = e->cold_cycles;
+    v->counters        = e->counters;
+    v->rejects         = e->rejects;
+    v->work            = e->work;
+    v->telemetry       = e->telemetry;
+    v->paired          = e->paired;
+    if (e->quantiles) {
+        v->quantiles  = checkasm_arena_alloc(arena, sizeof(*v->quantiles));
+        *v->quantiles = *e->quantiles;
+    }
+
+    return 1;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2025, Niklas Haas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CHECKASM_CHECKPOINT_H
+#define CHECKASM_CHECKPOINT_H
+
+#include <stdio.h>
+
+#include "function.h"
+
+/* Results of function versions that finished benchmarking, see --checkpoint
+ * and --resume. The file is written in native byte order and with the raw
+ * in-memory layout of the measurements, so it can only be resumed by the same
+ * build of checkasm on the same system. */
+typedef struct CheckasmCheckpointEntry {
+    char               *test;   /* test name */
+    char               *name;   /* function name */
+    char               *suffix; /* version suffix */
+    unsigned            seed;
+    CheckasmMeasurement cycles;
+    CheckasmMeasurement threaded_cycles;
+    CheckasmMeasurement worker_cycles;
+    CheckasmMeasurement latency;
+    CheckasmMeasurement cold_cycles;
+    CheckasmHistogram  *quantiles; /* optional */
+    CheckasmCounters    counters;
+    CheckasmRejects     rejects;
+    CheckasmWork        work;
+    CheckasmTelemetry   telemetry;
+    CheckasmPaired      paired;
+} CheckasmCheckpointEntry;
+
+typedef struct CheckasmCheckpoint {
+    CheckasmCheckpointEntry *entries; /* sorted, only when resuming */
+    int                      nb_entries;
+    int                      size;
+    FILE                    *file;
+    const char              *path;
+    unsigned                 seed; /* of the run that created the file */
+} CheckasmCheckpoint;
+
+/* Creates the checkpoint file for a run starting at `seed`. If `resume` is set
+ * and the file already exists, its entries and seed are loaded first and
+ * carried over; a truncated entry at the end (e.g. from a killed process) is
+ * discarded. Without `resume`, an existing file is an error. Returns 0 on
+ * success, prints an error message otherwise */
+int  checkasm_checkpoint_open(CheckasmCheckpoint *cp, const char *path,
+                              const char *fingerprint, unsigned seed, int resume);
+void checkasm_checkpoint_close(CheckasmCheckpoint *cp);
+
+/* Durably appends the results of a function version to the file. Returns 0
+ * on success, prints an error message otherwise */
+int checkasm_checkpoint_add(CheckasmCheckpoint *cp, const char *test, const char *name,
+                            const char *suffix, unsigned seed,
+                            const CheckasmFuncVersion *v);
+
+/* Copies the results of a previously finished function version into `v`,
+ * allocating from `arena` as needed. Returns 1 if found, 0 otherwise */
+int checkasm_checkpoint_restore(const CheckasmCheckpoint *cp, const char *test,
+                                const char *name, const char *suffix, unsigned seed,
+                                CheckasmFuncVersion *v, CheckasmArena *arena);
+
+#endif /* CHECKASM_CHECKPOINT_H */
@@ -33,8 +33,13 @@
 #ifdef __APPLE__
   #include <sys/sysctl.h>
 #endif
+#ifdef __linux__
+  #include <unistd.h>
+#endif
 
 #include <inttypes.h>
+#include <math.h>
+#include <string.h>
 
 #include "cpu.h"
 #include "internal.h"
@@ -62,6 +67,108 @@ COLD unsigned long checkasm_getauxval(unsigned long type)
 #endif
 }
 
+/* Size of the given data cache level (0 = L1, 1 = L2, 2 = L3), in bytes */
+static COLD size_t cache_size(const int level)
+{
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    static const int names[] = {
+        _SC_LEVEL1_DCACHE_SIZE,
+        _SC_LEVEL2_CACHE_SIZE,
+        _SC_LEVEL3_CACHE_SIZE,
+    };
+
+    const long size = sysconf(names[level]);
+    if (size > 0)
+        return (size_t) size;
+#endif
+
+    /* Conservative guesses, erring on the large side */
+    static const size_t defaults[] = { 64 << 10, 2 << 20, 64 << 20 };
+    return defaults[level];
+}
+
+static uint8_t *evict_buf;
+static size_t   evict_size;
+
+void checkasm_evict_cache(const CheckasmCacheState state)
+{
+    if (state == CHECKASM_CACHE_HOT)
+        return;
+
+    /* Touch twice the size of the highest cache level to evict */
+    const size_t size = 2 * cache_size(state - CHECKASM_CACHE_L2);
+    if (size > evict_size) {
+        free(evict_buf);
+        evict_buf = checkasm_handle_oom(malloc(size));
+        /* Make sure all pages are actually backed by distinct memory */
+        memset(evict_buf, 1, size);
+        evict_size = size;
+    }
+
+    const volatile uint8_t *const buf = evict_buf;
+    uint8_t                       sum = 0;
+    for (size_t i = 0; i < size; i += 64)
+        sum += buf[i];
+    (void) sum;
+}
+
+void checkasm_evict_cache_uninit(void)
+{
+    free(evict_buf);
+    evict_buf  = NULL;
+    evict_size = 0;
+}
+
+/* Time spent measuring each level; the best of all passes is kept, to filter
+ * out interrupts and frequency ramp-up */
+#define BANDWIDTH_NSEC   10000000 /* 10 ms */
+#define BANDWIDTH_PASSES 4
+
+/* Sustained bytes per nsec (read plus written) copying between the two halves
+ * of a buffer of `size` bytes */
+static COLD double measure_bandwidth(uint8_t *const buf, const size_t size)
+{
+    const size_t half = size / 2;
+    /* Copy at least 1 MB per pass, to stay well above the timer resolution */
+    const size_t reps  = ((1 << 20) + half - 1) / half;
+    double       best  = 0.0;
+    uint64_t     total = 0;
+
+    for (int pass = 0; pass < BANDWIDTH_PASSES || total < BANDWIDTH_NSEC; pass++) {
+        uint64_t nsec = checkasm_gettime_nsec();
+        for (size_t i = 0; i < reps; i++) {
+            /* Alternate directions, so both halves stay in the same cache level */
+            uint8_t *const dst = buf + (i & 1) * half;
+            memcpy(dst, buf + half - (i & 1) * half, half);
+        }
+        nsec = checkasm_gettime_nsec_diff(nsec);
+        total += nsec;
+        if (nsec)
+            best = fmax(best, 2.0 * half * reps / nsec);
+    }
+
+    return best;
+}
+
+COLD void checkasm_measure_roofline(CheckasmRoofline *const roof)
+{
+    /* Measure each cache level with a working set of half its size, and DRAM
+     * with twice the size of the last level cache */
+    const size_t   size = 2 * cache_size(CHECKASM_CACHE_LLC);
+    uint8_t *const buf  = checkasm_handle_oom(malloc(size));
+    memset(buf, 1, size);
+
+    for (int level = CHECKASM_CACHE_HOT; level < CHECKASM_CACHE_DRAM; level++) {
+        roof->size[level]      = cache_size(level);
+        roof->bandwidth[level] = measure_bandwidth(buf, roof->size[level] / 2);
+    }
+    roof->size[CHECKASM_CACHE_DRAM]      = SIZE_MAX;
+    roof->bandwidth[CHECKASM_CACHE_DRAM] = measure_bandwidth(buf, size);
+
+    roof->peak_ops = checkasm_measure_peak_ops(&roof->peak_isa);
+    free(buf);
+}
+
 static COLD const char *get_brand_string(char *buf, size_t buflen, int affinity)
 {
 #if ARCH_X86
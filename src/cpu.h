@@ -62,6 +62,15 @@ char *checkasm_get_x86_cpuid(char *buf, size_t buflen);
  * those registers to keep them powered on. */
 void checkasm_simd_warmup(void);
 
+/* Widest SIMD extension usable for floating point multiply-adds */
+typedef enum CheckasmX86Simd {
+    CHECKASM_X86_SIMD_BASELINE,
+    CHECKASM_X86_SIMD_AVX2, /* with FMA */
+    CHECKASM_X86_SIMD_AVX512,
+} CheckasmX86Simd;
+
+CheckasmX86Simd checkasm_get_x86_simd(void);
+
 #elif ARCH_RISCV
 
 /* Gets the CPU identification registers. */
@@ -131,6 +140,25 @@ const char *checkasm_get_arm_cpuinfo(char *buf, size_t buflen, int affinity);
 const char *checkasm_get_arm_win32_reg(char *buf, size_t buflen, int affinity);
 #endif
 
+/* Evict the data caches such that anything accessed before this call is only
+ * present in the cache level specified by `state` (or beyond) */
+void checkasm_evict_cache(CheckasmCacheState state);
+void checkasm_evict_cache_uninit(void);
+
+/* Machine limits for the roofline model (see cfg.roofline), indexed by the
+ * memory level holding the working set */
+typedef struct CheckasmRoofline {
+    size_t      size[CHECKASM_CACHE_DRAM + 1];      /* capacity of each level */
+    double      bandwidth[CHECKASM_CACHE_DRAM + 1]; /* sustained bytes per nsec (GB/s) */
+    double      peak_ops;                           /* arithmetic ops per nsec */
+    const char *peak_isa;                           /* instruction set of peak_ops */
+} CheckasmRoofline;
+
+/* Measure the sustained copy bandwidth of each cache level and of DRAM, and the
+ * peak throughput of a multiply-add loop vectorized for the widest supported
+ * instruction set. Takes about 50 ms */
+void checkasm_measure_roofline(CheckasmRoofline *roof);
+
 /* Iterate over all known CPU information and run the callback on each line */
 void checkasm_cpu_info(void (*info_cb)(void *priv, const char *fmt, ...), void *priv,
                        const CheckasmConfig *config);
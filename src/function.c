@@ -27,38 +27,19 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "function.h"
 #include "internal.h"
 
-/* Deallocate a tree */
-static void func_uninit(CheckasmFunc *const f)
-{
-    if (!f)
-        return;
-
-    CheckasmFuncVersion *v = f->versions.next;
-    while (v) {
-        CheckasmFuncVersion *next = v->next;
-        free(v->suffix);
-        free(v);
-        v = next;
-    }
-
-    CheckasmFunc *const left  = f->child[0];
-    CheckasmFunc *const right = f->child[1];
-    free(f->report_name);
-    free(f);
-
-    func_uninit(right);
-    func_uninit(left);
-}
-
 void checkasm_func_tree_uninit(CheckasmFuncTree *tree)
 {
-    func_uninit(tree->root);
+    checkasm_arena_uninit(&tree->arena);
+    free(tree->table);
     memset(tree, 0, sizeof(*tree));
 }
 
@@ -110,39 +91,272 @@ static void tree_balance(CheckasmFunc **const root)
         *root = tree_rotate(f, 1); /* Rotate right */
 }
 
-/* Get a node with the specified name, creating it if it doesn't exist; returns
- * 1 if a new node was inserted, 0 otherwise. */
-static int func_get(CheckasmFunc **const root, const char *const name,
-                    CheckasmFunc **const out_func)
+/* Insert a node with a unique name into the tree */
+static void tree_insert(CheckasmFunc **const root, CheckasmFunc *const node)
 {
-    CheckasmFunc *f = *root;
+    CheckasmFunc *const f = *root;
     if (!f) {
-        /* Allocate and insert a new node into the tree */
-        const size_t name_length = strlen(name) + 1;
-        f = checkasm_mallocz(offsetof(CheckasmFunc, name) + name_length);
-        memcpy(f->name, name, name_length);
-        *out_func = *root = f;
-        return 1;
+        *root = node;
+        return;
     }
 
-    /* Search the tree for a matching node */
-    const int cmp = cmp_func_names(name, f->name);
-    if (!cmp) {
-        *out_func = f;
-        return 0;
+    tree_insert(&f->child[cmp_func_names(node->name, f->name) > 0], node);
+    tree_balance(root); /* Rebalance the tree on the way up */
+}
+
+CheckasmFunc *checkasm_func_tree_sorted(CheckasmFuncTree *tree)
+{
+    for (CheckasmFunc *f = tree->unsorted; f; f = f->next) {
+        tree_insert(&tree->root, f);
+        tree->root->color = 1; /* Ensure root is black */
+    }
+
+    tree->unsorted = NULL;
+    return tree->root;
+}
+
+/* 32-bit FNV-1a */
+static uint32_t hash_name(const char *name, size_t *const length)
+{
+    const char *const start = name;
+
+    uint32_t hash = 0x811c9dc5;
+    for (; *name; name++)
+        hash = (hash ^ (uint8_t) *name) * 0x01000193;
+
+    *length = name - start;
+    return hash;
+}
+
+/* Double the size of the hash table, re-inserting all functions */
+static void table_grow(CheckasmFuncTree *const tree)
+{
+    const uint32_t size = tree->table_size ? 2 * tree->table_size : 256;
+    CheckasmFunc **table = checkasm_mallocz(size * sizeof(*table));
+
+    for (CheckasmFunc *f = tree->first; f; f = f->next) {
+        uint32_t idx = f->hash & (size - 1);
+        while (table[idx])
+            idx = (idx + 1) & (size - 1);
+        table[idx] = f;
     }
 
-    int inserted = func_get(&f->child[cmp > 0], name, out_func);
-    if (inserted)
-        tree_balance(root); /* Rebalance the tree on the way up */
-    return inserted;
+    free(tree->table);
+    tree->table      = table;
+    tree->table_size = size;
 }
 
 CheckasmFunc *checkasm_func_get(CheckasmFuncTree *tree, const char *const name)
 {
-    CheckasmFunc *func     = NULL;
-    int           inserted = func_get(&tree->root, name, &func);
-    if (inserted)
-        tree->root->color = 1; /* Ensure root is black */
-    return func;
+    /* Keep the load factor below 1/2 */
+    if (2 * (tree->nb_funcs + 1) > tree->table_size)
+        table_grow(tree);
+
+    size_t         name_length;
+    const uint32_t hash = hash_name(name, &name_length);
+    const uint32_t mask = tree->table_size - 1;
+
+    uint32_t idx = hash & mask;
+    for (CheckasmFunc *f; (f = tree->table[idx]); idx = (idx + 1) & mask) {
+        if (f->hash == hash && !strcmp(f->name, name))
+            return f;
+    }
+
+    /* Allocate a new node, to be inserted into the sorted tree on demand */
+    CheckasmFunc *const f
+        = checkasm_arena_alloc(&tree->arena, offsetof(CheckasmFunc, name) + name_length + 1);
+    memcpy(f->name, name, name_length + 1);
+    f->hash          = hash;
+    tree->table[idx] = f;
+    tree->nb_funcs++;
+
+    if (tree->last)
+        tree->last->next = f;
+    else
+        tree->first = f;
+    tree->last = f;
+    if (!tree->unsorted)
+        tree->unsorted = f;
+    return f;
+}
+
+CheckasmFuncVersion *checkasm_func_version_alloc(CheckasmFuncTree *tree)
+{
+    return checkasm_arena_alloc(&tree->arena, sizeof(CheckasmFuncVersion));
+}
+
+static int write_str(const char *str, FILE *f)
+{
+    const uint32_t len = str ? (uint32_t) strlen(str) + 1 : 0;
+    return fwrite(&len, sizeof(len), 1, f) != 1 || fwrite(str, 1, len, f) != len;
+}
+
+static char *read_str(FILE *f)
+{
+    uint32_t len;
+    if (fread(&len, sizeof(len), 1, f) != 1 || !len)
+        return NULL;
+
+    char *str = checkasm_mallocz(len);
+    if (fread(str, 1, len, f) != len || str[len - 1]) {
+        free(str);
+        return NULL;
+    }
+    return str;
+}
+
+typedef struct SerializedVersion {
+    const CheckasmCpuInfo *cpu;
+    CheckasmKey            key;
+    CheckasmFuncState      state;
+    int                    has_suffix;
+    int                    has_quantiles;
+    unsigned               iter;
+} SerializedVersion;
+
+static int func_write(const CheckasmFunc *const f, FILE *const out)
+{
+    uint32_t num_versions = 0;
+    for (const CheckasmFuncVersion *v = &f->versions; v; v = v->next)
+        num_versions++;
+
+    if (write_str(f->name, out) || write_str(f->report_name, out)
+        || fwrite(&f->test_name, sizeof(f->test_name), 1, out) != 1
+        || fwrite(&num_versions, sizeof(num_versions), 1, out) != 1)
+        return 1;
+
+    for (const CheckasmFuncVersion *v = &f->versions; v; v = v->next) {
+        const SerializedVersion sv = {
+            .cpu           = v->cpu,
+            .key           = v->key,
+            .state         = v->state,
+            .has_suffix    = !!v->suffix,
+            .has_quantiles = !!v->quantiles,
+            .iter          = v->iter,
+        };
+
+        if (fwrite(&sv, sizeof(sv), 1, out) != 1
+            || (sv.has_suffix && write_str(v->suffix, out))
+            || fwrite(&v->cycles, sizeof(v->cycles), 1, out) != 1
+            || fwrite(&v->threaded_cycles, sizeof(v->threaded_cycles), 1, out) != 1
+            || fwrite(&v->worker_cycles, sizeof(v->worker_cycles), 1, out) != 1
+            || fwrite(&v->latency, sizeof(v->latency), 1, out) != 1
+            || fwrite(&v->cold_cycles, sizeof(v->cold_cycles), 1, out) != 1
+            || fwrite(&v->counters, sizeof(v->counters), 1, out) != 1
+            || fwrite(&v->rejects, sizeof(v->rejects), 1, out) != 1
+            || fwrite(&v->work, sizeof(v->work), 1, out) != 1
+            || fwrite(&v->telemetry, sizeof(v->telemetry), 1, out) != 1
+            || fwrite(&v->paired, sizeof(v->paired), 1, out) != 1
+            || (sv.has_quantiles
+                && fwrite(v->quantiles, sizeof(*v->quantiles), 1, out) != 1))
+            return 1;
+    }
+
+    return 0;
+}
+
+int checkasm_func_tree_write(const CheckasmFuncTree *tree, FILE *f)
+{
+    for (const CheckasmFunc *func = tree->first; func; func = func->next) {
+        if (func_write(func, f))
+            return 1;
+    }
+
+    /* Terminated by an empty name */
+    return write_str(NULL, f) || fflush(f);
+}
+
+int checkasm_func_tree_read(CheckasmFuncTree *tree, FILE *in)
+{
+    char *name;
+    while ((name = read_str(in))) {
+        CheckasmFunc *const f = checkasm_func_get(tree, name);
+        free(name);
+
+        char    *report_name = read_str(in);
+        uint32_t num_versions;
+        if (fread(&f->test_name, sizeof(f->test_name), 1, in) != 1
+            || fread(&num_versions, sizeof(num_versions), 1, in) != 1) {
+            free(report_name);
+            return 1;
+        }
+
+        if (report_name && !f->report_name)
+            f->report_name = checkasm_arena_strdup(&tree->arena, report_name);
+        free(report_name);
+
+        /* Find the end of the existing version list */
+        CheckasmFuncVersion *prev = NULL;
+        if (f->versions.key) {
+            prev = &f->versions;
+            while (prev->next)
+                prev = prev->next;
+        }
+
+        for (uint32_t i = 0; i < num_versions; i++) {
+            SerializedVersion sv;
+            if (fread(&sv, sizeof(sv), 1, in) != 1)
+                return 1;
+
+            CheckasmFuncVersion *v = &f->versions;
+            if (prev)
+                v = prev->next = checkasm_func_version_alloc(tree);
+
+            v->cpu   = sv.cpu;
+            v->key   = sv.key;
+            v->state = sv.state;
+            v->iter  = sv.iter;
+            if (sv.has_suffix) {
+                char *const suffix = read_str(in);
+                if (!suffix)
+                    return 1;
+                v->suffix = checkasm_arena_strdup(&tree->arena, suffix);
+                free(suffix);
+            }
+            if (fread(&v->cycles, sizeof(v->cycles), 1, in) != 1
+                || fread(&v->threaded_cycles, sizeof(v->threaded_cycles), 1, in) != 1
+                || fread(&v->worker_cycles, sizeof(v->worker_cycles), 1, in) != 1
+                || fread(&v->latency, sizeof(v->latency), 1, in) != 1
+                || fread(&v->cold_cycles, sizeof(v->cold_cycles), 1, in) != 1
+                || fread(&v->counters, sizeof(v->counters), 1, in) != 1
+                || fread(&v->rejects, sizeof(v->rejects), 1, in) != 1
+                || fread(&v->work, sizeof(v->work), 1, in) != 1
+                || fread(&v->telemetry, sizeof(v->telemetry), 1, in) != 1
+                || fread(&v->paired, sizeof(v->paired), 1, in) != 1)
+                return 1;
+            if (sv.has_quantiles) {
+                v->quantiles = checkasm_arena_alloc(&tree->arena, sizeof(*v->quantiles));
+                if (fread(v->quantiles, sizeof(*v->quantiles), 1, in) != 1)
+                    return 1;
+            }
+            prev = v;
+        }
+    }
+
+    return 0;
+}
+
+void checkasm_func_tree_merge(CheckasmFuncTree *dst, CheckasmFuncTree *src)
+{
+    for (CheckasmFunc *f = src->first; f; f = f->next) {
+        CheckasmFunc *const d = checkasm_func_get(dst, f->name);
+        if (!d->test_name)
+            d->test_name = f->test_name;
+        if (!d->report_name)
+            d->report_name = f->report_name;
+
+        if (d->versions.key) {
+            CheckasmFuncVersion *prev = &d->versions;
+            while (prev->next)
+                prev = prev->next;
+            prev->next  = checkasm_func_version_alloc(dst);
+            *prev->next = f->versions;
+        } else {
+            d->versions = f->versions;
+        }
+    }
+
+    /* Everything referenced by the merged versions is now owned by `dst` */
+    checkasm_arena_merge(&dst->arena, &src->arena);
+    checkasm_func_tree_uninit(src);
 }
@@ -29,7 +29,10 @@
 #ifndef CHECKASM_FUNCTION_H
 #define CHECKASM_FUNCTION_H
 
+#include <stdio.h>
+
 #include "checkasm/checkasm.h"
+#include "internal.h"
 #include "stats.h"
 
 typedef enum CheckasmFuncState {
@@ -44,22 +47,47 @@ typedef struct CheckasmFuncVersion {
     char                       *suffix; /* optional custom suffix */
     CheckasmKey                 key;
     CheckasmMeasurement         cycles;
+    CheckasmMeasurement         threaded_cycles; /* with cfg.bench_threads */
+    CheckasmMeasurement         worker_cycles;   /* the other threads, likewise */
+    CheckasmMeasurement         latency;         /* serially dependent calls */
+    CheckasmMeasurement         cold_cycles;     /* with cfg.cache_state */
+    CheckasmHistogram          *quantiles;       /* with cfg.bench_quantiles */
+    CheckasmCounters            counters;
+    CheckasmRejects             rejects; /* outliers in the regular measurement */
+    CheckasmWork                work;
+    CheckasmTelemetry           telemetry; /* with cfg.telemetry */
+    CheckasmPaired              paired;    /* with cfg.bench_paired */
     CheckasmFuncState           state;
+    uint64_t                    trace_id; /* set once announced in cfg.trace_file */
+    int                         streamed; /* already printed as CHECKASM_FORMAT_NDJSON */
+    int                         checkpointed; /* saved in or restored from a checkpoint */
+    unsigned                    iter;         /* last --repeat iteration tested in */
 } CheckasmFuncVersion;
 
 typedef struct CheckasmFunc {
     struct CheckasmFunc *child[2];
     struct CheckasmFunc *prev; /* previous function in current report group */
+    struct CheckasmFunc *next; /* next function in order of creation */
     CheckasmFuncVersion  versions;
     const char          *test_name;
     char                *report_name;
     int                  report_idx; /* when was this function last reported? */
+    uint32_t             hash;
     uint8_t              color; /* 0 = red, 1 = black */
     char                 name[];
 } CheckasmFunc;
 
+/* All functions and versions are allocated from the arena. Functions are
+ * looked up by name via a hash table, and only inserted into the sorted tree
+ * once it's actually needed, see checkasm_func_tree_sorted(). */
 typedef struct CheckasmFuncTree {
-    CheckasmFunc *root;
+    CheckasmFunc  *root;           /* sorted by name (left-leaning red-black tree) */
+    CheckasmFunc  *first, *last;   /* all functions, in order of creation */
+    CheckasmFunc  *unsorted;       /* first function not yet inserted into root */
+    CheckasmFunc **table;          /* open addressing, by hash */
+    uint32_t       table_size;     /* power of two */
+    uint32_t       nb_funcs;
+    CheckasmArena  arena;
 } CheckasmFuncTree;
 
 /* Free all resources associated with a function tree and set it to {0}. */
@@ -68,4 +96,23 @@ void checkasm_func_tree_uninit(CheckasmFuncTree *tree);
 /* Get the node for a given function name, creating it if it doesn't exist. */
 CheckasmFunc *checkasm_func_get(CheckasmFuncTree *tree, const char *name);
 
+/* Insert all new functions into the sorted tree, and return its root. */
+CheckasmFunc *checkasm_func_tree_sorted(CheckasmFuncTree *tree);
+
+/* Allocate a new (zero-initialized) version, owned by the tree. */
+CheckasmFuncVersion *checkasm_func_version_alloc(CheckasmFuncTree *tree);
+
+/* Serialize all functions and versions in a tree to a binary stream. Pointers
+ * (keys, CPU info, test names) are written as-is, so this is only meaningful
+ * for exchanging results between fork()ed processes. Returns 0 on success. */
+int checkasm_func_tree_write(const CheckasmFuncTree *tree, FILE *f);
+
+/* Merge a tree previously written by checkasm_func_tree_write() into `tree`.
+ * Versions of already existing functions are appended. Returns 0 on success. */
+int checkasm_func_tree_read(CheckasmFuncTree *tree, FILE *f);
+
+/* Move all functions and versions from `src` into `dst`, appending versions
+ * of already existing functions, and reset `src` to {0}. */
+void checkasm_func_tree_merge(CheckasmFuncTree *dst, CheckasmFuncTree *src);
+
 #endif /* CHECKASM_FUNCTION_H */
@@ -0,0 +1,182 @@
+/*
+ * Copyright © 2025, Niklas Haas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "checkasm_config.h"
+
+#if HAVE_MPROTECT
+  /* _DEFAULT_SOURCE is required for MAP_ANONYMOUS on glibc. */
+  #ifndef _DEFAULT_SOURCE
+    #define _DEFAULT_SOURCE
+  #endif
+  #include <sys/mman.h>
+  #include <unistd.h>
+  #if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+    #define MAP_ANONYMOUS MAP_ANON
+  #endif
+#elif defined(_WIN32)
+  #include <windows.h>
+#endif
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "checkasm/utils.h"
+#include "internal.h"
+
+typedef struct GuardedBuffer {
+    char  *map;        /* start of the whole mapping, including both guard pages */
+    size_t map_size;
+    size_t guard_size; /* 0 if guard pages are not supported */
+    char  *buf;        /* as returned to the caller */
+    size_t size;
+} GuardedBuffer;
+
+/* All live buffers, in order of allocation */
+static struct {
+    GuardedBuffer *bufs;
+    int            nb_bufs;
+    int            size;
+} guarded;
+
+static size_t page_size(void)
+{
+#if HAVE_MPROTECT
+    return sysconf(_SC_PAGESIZE);
+#elif defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return 0;
+#endif
+}
+
+void *checkasm_alloc_guarded(const size_t size, size_t align, const CheckasmGuard side)
+{
+    if (!align)
+        align = 1;
+
+    const size_t  page = page_size();
+    GuardedBuffer b    = { .size = size };
+    assert(!(align & (align - 1)) && (!page || align <= page));
+
+    /* Round up to whole pages, and place the buffer at the requested end */
+    const size_t aligned_size = CHECKASM_ROUND(size, align);
+    const size_t data_size    = page ? CHECKASM_ROUND(aligned_size, page) : 0;
+    const size_t offset = side == CHECKASM_GUARD_END ? data_size - aligned_size : 0;
+
+#if HAVE_MPROTECT
+    b.guard_size = page;
+    b.map_size   = data_size + 2 * page;
+    b.map = mmap(NULL, b.map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1, 0);
+    if (b.map == MAP_FAILED)
+        b.map = NULL;
+    if (b.map && (mprotect(b.map, page, PROT_NONE)
+                  || mprotect(b.map + page + data_size, page, PROT_NONE))) {
+        munmap(b.map, b.map_size);
+        b.map = NULL;
+    }
+#elif defined(_WIN32)
+    DWORD old;
+    b.guard_size = page;
+    b.map_size   = data_size + 2 * page;
+    b.map = VirtualAlloc(NULL, b.map_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (b.map
+        && (!VirtualProtect(b.map, page, PAGE_NOACCESS, &old)
+            || !VirtualProtect(b.map + page + data_size, page, PAGE_NOACCESS, &old))) {
+        VirtualFree(b.map, 0, MEM_RELEASE);
+        b.map = NULL;
+    }
+#else
+    /* No way to protect pages, just return a regular buffer */
+    b.map_size = aligned_size + align - 1;
+    b.map      = malloc(b.map_size ? b.map_size : 1);
+#endif
+
+    checkasm_handle_oom(b.map);
+    b.buf = page ? b.map + page + offset
+                 : (char *) CHECKASM_ROUND((uintptr_t) b.map, (uintptr_t) align);
+
+    if (guarded.nb_bufs == guarded.size) {
+        guarded.size = guarded.size ? 2 * guarded.size : 16;
+        guarded.bufs = checkasm_handle_oom(
+            realloc(guarded.bufs, guarded.size * sizeof(*guarded.bufs)));
+    }
+    guarded.bufs[guarded.nb_bufs++] = b;
+    return b.buf;
+}
+
+void checkasm_free_guarded(void *const ptr)
+{
+    if (!ptr)
+        return;
+
+    for (int i = guarded.nb_bufs - 1; i >= 0; i--) {
+        const GuardedBuffer b = guarded.bufs[i];
+        if (b.buf != ptr)
+            continue;
+
+#if HAVE_MPROTECT
+        munmap(b.map, b.map_size);
+#elif defined(_WIN32)
+        VirtualFree(b.map, 0, MEM_RELEASE);
+#else
+        free(b.map);
+#endif
+        guarded.bufs[i] = guarded.bufs[--guarded.nb_bufs];
+        return;
+    }
+
+    assert(!"checkasm_free_guarded() called on an unknown pointer");
+}
+
+const char *checkasm_guard_fault_desc(const uintptr_t addr, const int access)
+{
+    static char desc[128];
+
+    for (int i = 0; i < guarded.nb_bufs; i++) {
+        const GuardedBuffer *b     = &guarded.bufs[i];
+        const uintptr_t      map   = (uintptr_t) b->map;
+        const uintptr_t      guard = map + b->map_size - b->guard_size;
+        if (!b->guard_size || !((addr >= map && addr < map + b->guard_size)
+                                || (addr >= guard && addr < guard + b->guard_size)))
+            continue;
+
+        /* The fault address is just the first byte that actually faulted, so
+         * the access itself may have started a bit earlier */
+        const char *const type = access == 'r' ? "read"
+                               : access == 'w' ? "write"
+                                               : "access";
+        snprintf(desc, sizeof(desc), "out-of-bounds %s at index %td of a %zu byte buffer",
+                 type, (ptrdiff_t) ((intptr_t) addr - (intptr_t) b->buf), b->size);
+        return desc;
+    }
+
+    return NULL;
+}
@@ -641,6 +641,8 @@
     title += " - " + units[0] + "s per " + units[1];
     if (measurement.numMeasurements > 1)
       title += " (last of " + measurement.numMeasurements + " runs)";
+    if (measurement.numIterations > 1)
+      title += ", " + measurement.numIterations + " iterations merged";
     new Chart(canvas.getContext("2d"), {
       type: "scatter",
       data: {
@@ -740,6 +742,232 @@
     return elem("div", { className: "scatter" }, [canvas]);
   }
 
+  // Distribution of individually timed calls, as a density over a log axis
+  function mkQuantiles(quantiles, title) {
+    const canvas = document.createElement("canvas");
+    const unit = quantiles.unit;
+    const markers = [
+      ["p50", quantiles.p50],
+      ["p90", quantiles.p90],
+      ["p99", quantiles.p99],
+      ["max", quantiles.max],
+    ];
+
+    // Buckets overlapping the timer overhead can't be placed on a log axis
+    const data = quantiles.rawHistogram.flatMap(function (bucket) {
+      const lo = bucket.cycles - quantiles.overhead;
+      const hi = lo + bucket.width;
+      if (lo <= 0)
+        return [];
+      const density = bucket.count / quantiles.numSamples / Math.log(hi / lo);
+      return [{ x: Math.sqrt(lo * hi), y: density }];
+    });
+
+    new Chart(canvas.getContext("2d"), {
+      type: "line",
+      data: {
+        datasets: [
+          {
+            label: "density",
+            borderColor: colors[0],
+            borderWidth: 2,
+            backgroundColor: colors[0] + "33",
+            data: data,
+            lineTension: 0,
+            pointRadius: 0,
+            pointHitRadius: 8,
+          },
+        ],
+      },
+      plugins: [
+        {
+          afterDraw: function (chart) {
+            const ctx = chart.ctx;
+            const area = chart.chartArea;
+            const axis = chart.scales[chart.options.scales.xAxes[0].id];
+            ctx.save();
+            ctx.strokeStyle = colors[1];
+            ctx.fillStyle = colors[1];
+            ctx.lineWidth = 1;
+            ctx.textAlign = "center";
+            markers.forEach(function ([label, value]) {
+              if (value <= 0)
+                return;
+              const x = axis.getPixelForValue(value);
+              ctx.beginPath();
+              ctx.moveTo(x, area.top + 12);
+              ctx.lineTo(x, area.bottom);
+              ctx.stroke();
+              ctx.fillText(label, x, area.top + 8);
+            });
+            ctx.restore();
+          },
+        },
+      ],
+      options: {
+        title: {
+          display: true,
+          text: title + " — " + unit + "s per call (" +
+            quantiles.numSamples.toLocaleString() + " calls)",
+        },
+        scales: {
+          xAxes: [
+            {
+              display: true,
+              type: "logarithmic",
+              scaleLabel: {
+                display: false,
+                labelString: unit + "s",
+              },
+              ticks: {
+                callback: function (value) {
+                  // Only label 1, 2 and 5 times powers of ten, to avoid clutter
+                  const mantissa = value / Math.pow(10, Math.floor(Math.log10(value)));
+                  if (![1, 2, 5].includes(Math.round(mantissa * 10) / 10))
+                    return "";
+                  return formatCycles(value, unit, 3);
+                },
+              },
+            },
+          ],
+          yAxes: [
+            {
+              display: false,
+              type: "linear",
+            },
+          ],
+        },
+        legend: {
+          display: false,
+        },
+        tooltips: {
+          mode: "nearest",
+          intersect: false,
+          callbacks: {
+            title: function () {
+              return "";
+            },
+            label: (item) => formatCycles(item.xLabel, unit + "s", 3),
+          },
+        },
+      },
+    });
+    return elem("div", { className: "kde" }, [canvas]);
+  }
+
+  // Roofline model: attainable op/s over arithmetic intensity (ops per byte),
+  // bounded by the bandwidth of each memory level and by the peak throughput
+  function mkRoofline(versions, roofline, title) {
+    const canvas = document.createElement("canvas");
+    const peak = roofline.peakOpsPerSecond;
+    const points = versions.map(function (version) {
+      return {
+        x: version.opsPerCall / version.bytesPerCall,
+        y: version.opsPerSecond.mode,
+        label: version.reportName,
+        color: colors[version.groupNumber % colors.length],
+      };
+    });
+
+    // Include the ridge point of every level, where it meets the peak
+    const ridges = roofline.levels.map((level) => peak / level.bytesPerSecond);
+    const xs = points.map((p) => p.x).concat(ridges);
+    const xmin = Math.min.apply(null, xs) / 2;
+    const xmax = Math.max.apply(null, xs) * 2;
+
+    const roofs = roofline.levels.map(function (level, i) {
+      const ridge = ridges[i];
+      const data = [{ x: xmin, y: Math.min(peak, level.bytesPerSecond * xmin) }];
+      if (ridge > xmin && ridge < xmax)
+        data.push({ x: ridge, y: peak });
+      data.push({ x: xmax, y: Math.min(peak, level.bytesPerSecond * xmax) });
+      return {
+        label: level.name,
+        data: data,
+        type: "line",
+        fill: false,
+        lineTension: 0,
+        borderWidth: 1,
+        borderColor: colors[i % colors.length],
+        backgroundColor: "#00000000",
+        pointRadius: 0,
+        pointHitRadius: 0,
+      };
+    });
+
+    const opsFormatter = (value) => formatUnit(value * rawUnits(value)[0], rawUnits(value)[1] + "op/s", 3);
+    new Chart(canvas.getContext("2d"), {
+      type: "scatter",
+      data: {
+        datasets: [
+          {
+            label: "versions",
+            data: points,
+            pointRadius: 4,
+            pointHitRadius: 8,
+            pointBackgroundColor: points.map((p) => p.color),
+            borderColor: "#000000",
+            borderWidth: 1,
+          },
+        ].concat(roofs),
+      },
+      options: {
+        title: {
+          display: true,
+          text: title + " — roofline (" + roofline.peakOpsIsa + " peak)",
+        },
+        scales: {
+          xAxes: [
+            {
+              display: true,
+              type: "logarithmic",
+              scaleLabel: {
+                display: true,
+                labelString: "ops per byte",
+              },
+              ticks: {
+                min: xmin,
+                max: xmax,
+                callback: function (value) {
+                  const mantissa = value / Math.pow(10, Math.floor(Math.log10(value)));
+                  return Math.round(mantissa * 10) / 10 === 1 ? String(value) : "";
+                },
+              },
+            },
+          ],
+          yAxes: [
+            {
+              display: true,
+              type: "logarithmic",
+              ticks: {
+                callback: function (value) {
+                  const mantissa = value / Math.pow(10, Math.floor(Math.log10(value)));
+                  return Math.round(mantissa * 10) / 10 === 1 ? opsFormatter(value) : "";
+                },
+              },
+            },
+          ],
+        },
+        legend: {
+          display: true,
+          position: "right",
+          labels: {
+            filter: (item) => item.datasetIndex > 0,
+          },
+        },
+        tooltips: {
+          filter: (item) => item.datasetIndex === 0,
+          callbacks: {
+            label: (item) =>
+              points[item.index].label + ": " + opsFormatter(item.yLabel) + " at " +
+              item.xLabel.toPrecision(3) + " ops/byte",
+          },
+        },
+      },
+    });
+    return elem("div", { className: "roofline" }, [canvas]);
+  }
+
   // Create an HTML Element with attributes and child nodes
   function elem(tag, props, children) {
     const node = document.createElement(tag);
@@ -804,9 +1032,13 @@
 
   const fmtTime  = t => formatTime(t, 3);
   const fmtRatio = x => x.toPrecision(3) + 'x';
+  const fmtPercent = x => (100 * x).toPrecision(3) + '%';
   function fmtCyclesUnit(unit) {
     return c => formatCycles(c, unit, 3);
   }
+  function fmtRate(unit) {
+    return x => formatUnit(x * rawUnits(x)[0], rawUnits(x)[1] + unit, 3);
+  }
 
   function tableEntry(label, formatter, value) {
     return Object.assign({ label: label, formatter: formatter }, value);
@@ -820,11 +1052,108 @@
       tableEntry("Raw cycles",      fmtCycles, report.rawCycles),
       tableEntry("Raw time",        fmtTime,   report.rawTime),
     ];
-    if (report.ratio)
+    if (report.adjustedThreadedCycles) {
+      rows.push(tableEntry("Adjusted cycles (threaded)", fmtCycles, report.adjustedThreadedCycles));
+      if (report.adjustedWorkerCycles)
+        rows.push(tableEntry("Adjusted cycles (workers)", fmtCycles, report.adjustedWorkerCycles));
+      rows.push(tableEntry("Scaling efficiency",         fmtPercent, report.scalingEfficiency));
+    }
+    if (report.adjustedLatency) {
+      rows.push(tableEntry("Adjusted latency", fmtCycles, report.adjustedLatency));
+      rows.push(tableEntry("Raw latency",      fmtCycles, report.rawLatency));
+    }
+    if (report.cyclesPerElement) {
+      rows.push(tableEntry("Cycles per element",  fmtCycles, report.cyclesPerElement));
+      rows.push(tableEntry("Elements per second", fmtRate("elem/s"), report.elementsPerSecond));
+    }
+    if (report.bytesPerSecond)
+      rows.push(tableEntry("Bandwidth", fmtRate("B/s"), report.bytesPerSecond));
+    if (report.opsPerSecond)
+      rows.push(tableEntry("Operations per second", fmtRate("op/s"), report.opsPerSecond));
+    if (report.roofline && report.roofline.bandwidthFraction) {
+      const label = "Bandwidth efficiency (" + report.roofline.memoryLevel + ")";
+      rows.push(tableEntry(label, fmtPercent, report.roofline.bandwidthFraction));
+    }
+    if (report.roofline && report.roofline.computeFraction)
+      rows.push(tableEntry("Compute efficiency", fmtPercent, report.roofline.computeFraction));
+    if (report.adjustedColdCycles) {
+      rows.push(tableEntry("Adjusted cycles (cold)", fmtCycles, report.adjustedColdCycles));
+      rows.push(tableEntry("Raw cycles (cold)",      fmtCycles, report.rawColdCycles));
+    }
+    if (report.unpairedRatio) {
+      rows.push(tableEntry("Speedup (paired)",   fmtRatio, report.ratio));
+      rows.push(tableEntry("Speedup (unpaired)", fmtRatio, report.unpairedRatio));
+    } else if (report.ratio) {
       rows.push(tableEntry("Speedup (vs ref)", fmtRatio, report.ratio));
+    }
     return mkTable(rows);
   }
 
+  function mkTelemetry(telemetry) {
+    var parts = [];
+    if (telemetry.clockRatio) {
+      parts.push(telemetry.clockRatio.toFixed(2) + "x reference clock (" +
+                 telemetry.clockRatioMin.toFixed(2) + "x - " +
+                 telemetry.clockRatioMax.toFixed(2) + "x, " +
+                 fmtPercent(telemetry.clockDrift) + " drift)");
+    }
+    if (telemetry.maxTemperature !== undefined)
+      parts.push("up to " + telemetry.maxTemperature.toFixed(0) + " °C");
+    if (telemetry.reruns)
+      parts.push(telemetry.reruns + " measurements rerun");
+    if (telemetry.unstableMeasurements)
+      parts.push(telemetry.unstableMeasurements + " unstable");
+    return elem("p", {}, ["Telemetry: " + parts.join(", ")]);
+  }
+
+  function mkQuantileTable(quantiles) {
+    const fmtCycles = fmtCyclesUnit(quantiles.unit + "s");
+    const rows = [
+      ["Median (p50)", quantiles.p50],
+      ["p90",          quantiles.p90],
+      ["p99",          quantiles.p99],
+      ["p99.9",        quantiles.p999],
+      ["Maximum",      quantiles.max],
+    ];
+    return elem("table", { className: "analysis" }, [
+      elem("thead", {}, [
+        elem("tr", {}, [elem("th"), elem("th", {}, ["per call"])]),
+      ]),
+      elem("tbody", {}, rows.map(function ([label, value]) {
+        return elem("tr", {}, [elem("td", {}, [label]), elem("td", {}, [fmtCycles(value)])]);
+      })),
+    ]);
+  }
+
+  function mkCounterTable(report) {
+    const prettyNames = {
+      cycles:          "Cycles",
+      refCycles:       "Reference cycles",
+      instructions:    "Instructions",
+      branchMisses:    "Branch misses",
+      l1dReadMisses:   "L1D read misses",
+      llcMisses:       "LLC misses",
+      taskClock:       "Task clock (ns)",
+      pageFaults:      "Page faults",
+      contextSwitches: "Context switches",
+    };
+    var rows = Object.entries(report.counters).map(function ([key, value]) {
+      return [prettyNames[key] || key, value.toPrecision(4)];
+    });
+    if (report.instructionsPerCycle)
+      rows.push(["Instructions per cycle", report.instructionsPerCycle.toPrecision(3)]);
+    if (report.clockRatio)
+      rows.push(["Clock ratio (vs reference)", report.clockRatio.toPrecision(3)]);
+    return elem("table", { className: "analysis" }, [
+      elem("thead", {}, [
+        elem("tr", {}, [elem("th"), elem("th", {}, ["per call"])]),
+      ]),
+      elem("tbody", {}, rows.map(function ([label, value]) {
+        return elem("tr", {}, [elem("td", {}, [label]), elem("td", {}, [value])]);
+      })),
+    ]);
+  }
+
   function mkNopTable(report) {
     const fmtCycles = fmtCyclesUnit(report.nopCycles.unit + "s");
     return mkTable([
@@ -879,16 +1208,35 @@
       testPattern:     "Test pattern",
       functionPattern: "Function pattern",
       benchUsec:       "Bench duration (µs)",
+      benchPrecision:  "Bench precision (%)",
+      cacheState:      "Cache state",
+      benchLatency:    "Latency benchmarks",
+      benchPaired:     "Paired benchmarks",
+      benchThreads:    "Bench threads",
+      benchQuantiles:  "Latency quantiles",
+      roofline:        "Roofline",
+      telemetry:       "Telemetry root",
+      stableEnv:       "Environment",
+      outliers:        "Outlier rejection",
+      traceFile:       "Trace file",
+      checkpointFile:  "Checkpoint file",
+      resume:          "Resumed",
       seed:            "Random seed",
       repeat:          "Repeat count",
+      mergeRepeats:    "Merged repeats",
+      exactInit:       "Exact checkasm_init()",
       cpuAffinity:     "CPU affinity",
+      perfCounters:    "Performance counters",
     };
     var items = [];
     Object.entries(config).forEach(function ([key, value]) {
       const label = prettyNames[key] || key;
+      const text = typeof value === "object" && !Array.isArray(value)
+        ? Object.entries(value).map(([k, v]) => k + " = " + v).join(", ")
+        : String(value);
       items.push(elem("li", {}, [
         elem("em", {}, [label + ": "]),
-        String(value),
+        text,
       ]));
     });
     return elem("details", { id: "configuration", className: "report-details" }, [
@@ -919,6 +1267,19 @@
         ]);
         overview.appendChild(testOverview);
 
+        // Versions with both bytes and ops per call, for the roofline chart
+        const rooflineVersions = Object.values(testData).flatMap((report) =>
+          Object.values(report.functions).flatMap((f) => Object.values(f.versions)),
+        ).filter((v) => v.opsPerSecond && v.bytesPerCall);
+        if (reportJSON.roofline && rooflineVersions.length) {
+          testOverview.appendChild(
+            elem("details", { class: "group-summary", open }, [
+              elem("summary", {}, ["roofline"]),
+              elem("p", {}, [mkRoofline(rooflineVersions, reportJSON.roofline, testName)]),
+            ]),
+          );
+        }
+
         Object.entries(testData).forEach(([reportName, report]) => {
           const height = overviewLineHeight * report.numVersions + 36;
           testOverview.appendChild(
@@ -959,6 +1320,21 @@
                   if (version.rawCycles.rawData)
                     body.appendChild(mkScatter(version.rawCycles, title));
                   body.appendChild(mkFuncTable(version));
+                  if (version.totalBatches) {
+                    body.appendChild(elem("p", {}, [
+                      "Rejected outliers: " + version.rejectedBatches.toLocaleString() +
+                      " of " + version.totalBatches.toLocaleString() + " batches (" +
+                      fmtPercent(version.rejectedFraction) + ")"
+                    ]));
+                  }
+                  if (version.telemetry)
+                    body.appendChild(mkTelemetry(version.telemetry));
+                  if (version.quantiles) {
+                    body.appendChild(mkQuantiles(version.quantiles, title));
+                    body.appendChild(mkQuantileTable(version.quantiles));
+                  }
+                  if (version.counters)
+                    body.appendChild(mkCounterTable(version));
                 });
               }
             });
@@ -94,6 +94,10 @@
 
 void checkasm_srand(unsigned seed);
 
+/* Generate the same checkasm_init() data as earlier versions, see
+ * CheckasmConfig.exact_init */
+extern int checkasm_exact_init;
+
 /* Internal variant of checkasm_fail_func() that also jumps back to the signal
  * handler */
 NORETURN void checkasm_fail_abort(const char *msg, ...) CHECKASM_PRINTF(1, 2);
@@ -134,6 +138,7 @@ typedef struct CheckasmJson {
     FILE *file;
     int   level;
     int   nonempty;
+    int   compact; /* print everything on a single line */
 } CheckasmJson;
 
 void checkasm_json(CheckasmJson *json, const char *key, const char *fmt, ...)
@@ -146,6 +151,11 @@ void checkasm_json_pop(CheckasmJson *json, char type);
 void        checkasm_set_signal_handlers(void);
 const char *checkasm_get_last_signal_desc(void);
 
+/* Describes a fault at `addr` if it hit a guard page of a buffer allocated by
+ * checkasm_alloc_guarded(), or returns NULL. `access` is 'r' or 'w' for a
+ * known read or write, 0 if unknown */
+const char *checkasm_guard_fault_desc(uintptr_t addr, int access);
+
 /* Set to 1 if the process should terminate. The current test will continue
  * executing until the next report() call, then the process will exit. */
 extern volatile sig_atomic_t checkasm_interrupted;
@@ -156,12 +166,31 @@ extern checkasm_jmp_buf checkasm_context;
 extern CheckasmPerf checkasm_perf;
 
 int checkasm_perf_init(void);
+void checkasm_perf_fork_child(void); /* call in every child created by fork() */
 int checkasm_perf_init_linux(CheckasmPerf *perf);
+int checkasm_perf_reopen_linux(void); /* no-op unless opened by the above */
+int checkasm_perf_init_rdpmc(CheckasmPerf *perf); /* sets perf->rdpmc only */
+int checkasm_perf_reopen_rdpmc(void); /* per-task, so not inherited by fork() */
 int checkasm_perf_init_macos(CheckasmPerf *perf);
 int checkasm_perf_init_arm(CheckasmPerf *perf);
 int checkasm_perf_validate_start(const CheckasmPerf *perf);
 int checkasm_perf_validate_start_stop(const CheckasmPerf *perf);
 
+/* Optional group of additional performance counters, sampled on every call to
+ * perf.stop() once enabled by checkasm_perf_init_counters() */
+typedef struct CheckasmPerfCounters {
+    int         nb_counters;
+    const char *names[CHECKASM_PERF_MAX_COUNTERS]; /* e.g. "instructions" */
+    uint64_t    values[CHECKASM_PERF_MAX_COUNTERS]; /* from the last perf.stop() */
+} CheckasmPerfCounters;
+
+extern CheckasmPerfCounters checkasm_perf_counters;
+
+/* Must be called after checkasm_perf_init(); disables the asm timing loop */
+int checkasm_perf_init_counters(void);
+int checkasm_perf_init_counters_linux(CheckasmPerf *perf);
+int checkasm_perf_reopen_counters_linux(void); /* after fork(), like the timer */
+
 int checkasm_run_on_all_cores(void (*func)(void));
 
 uint64_t checkasm_gettime_nsec(void);
@@ -171,8 +200,16 @@ void     checkasm_noop(void *);
 
 /* These functions update the measurements in `meas` directly; must be initialized */
 void checkasm_measure_nop_cycles(CheckasmMeasurement *meas, uint64_t target_cycles);
+void checkasm_measure_nop_cycles_serial(CheckasmMeasurement *meas, uint64_t target_cycles);
+void checkasm_measure_nop_cycles_single(CheckasmMeasurement *meas);
 void checkasm_measure_perf_scale(CheckasmMeasurement *meas); /* ns per cycle */
 
+/* Arithmetic ops per nsec of a multiply-add loop, as vectorized by the compiler
+ * for the widest instruction set it can target at runtime (currently AVX2 or
+ * AVX-512 with FMA on x86, the baseline elsewhere), whose name is returned in
+ * `isa` (see cfg.roofline) */
+double checkasm_measure_peak_ops(const char **isa);
+
 /* Miscellaneous helpers */
 static inline int imax(const int a, const int b)
 {
@@ -206,4 +243,21 @@ static inline char *checkasm_strdup(const char *str)
 
 char *checkasm_vasprintf(const char *fmt, va_list arg);
 
+/* Bump allocator for objects which are all freed at the same time */
+typedef struct CheckasmArena {
+    struct CheckasmArenaBlock *block; /* current block, linked to the older ones */
+} CheckasmArena;
+
+/* Allocate a zero-initialized block from the arena, exit on failure */
+void *checkasm_arena_alloc(CheckasmArena *arena, size_t size);
+char *checkasm_arena_strdup(CheckasmArena *arena, const char *str);
+
+/* Move all allocations from `src` into `dst`, and reset `src` to {0} */
+void checkasm_arena_merge(CheckasmArena *dst, CheckasmArena *src);
+
+/* Free all allocations at once, and reset the arena to {0}. The underlying
+ * memory is kept for reuse by other arenas until checkasm_arena_release() */
+void checkasm_arena_uninit(CheckasmArena *arena);
+void checkasm_arena_release(void);
+
 #endif /* CHECKASM_INTERNAL_H */
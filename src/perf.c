@@ -33,6 +33,7 @@
 
 #include "checkasm/perf.h"
 #include "checkasm/test.h"
+#include "cpu.h"
 #include "internal.h"
 #include "perf_internal.h"
 #include "stats.h"
@@ -49,7 +50,23 @@ static uint64_t perf_stop_asm(uint64_t t)
 }
 #endif
 
-CheckasmPerf checkasm_perf;
+#ifdef CHECKASM_PERF_RDPMC
+/* The counter can be lost in a forked child, see checkasm_perf_fork_child() */
+static uint64_t perf_start_rdpmc(void)
+{
+    const CheckasmRdpmc *const pmc = checkasm_perf.rdpmc;
+    return pmc ? CHECKASM_PERF_RDPMC(pmc) : CHECKASM_PERF_ASM();
+}
+
+static uint64_t perf_stop_rdpmc(uint64_t t)
+{
+    const CheckasmRdpmc *const pmc = checkasm_perf.rdpmc;
+    return (pmc ? CHECKASM_PERF_RDPMC(pmc) : CHECKASM_PERF_ASM()) - t;
+}
+#endif
+
+CheckasmPerf         checkasm_perf;
+CheckasmPerfCounters checkasm_perf_counters;
 
 const CheckasmPerf *checkasm_get_perf(void)
 {
@@ -64,6 +81,27 @@ COLD int checkasm_perf_init(void)
         return 1;
     }
 
+#if defined(CHECKASM_PERF_RDPMC) && HAVE_LINUX_PERF && CHECKASM_HAVE_LONGJMP
+    /* Prefer reading the actual core cycle counter, if the kernel allows it */
+    if (!checkasm_perf_init_rdpmc(&checkasm_perf)) {
+        if (!checkasm_save_context(checkasm_context)) {
+            checkasm_set_signal_handler_state(1);
+            checkasm_perf.start      = perf_start_rdpmc;
+            checkasm_perf.stop       = perf_stop_rdpmc;
+            checkasm_perf.name       = "linux (rdpmc)";
+            checkasm_perf.unit       = "cycle";
+            checkasm_perf.asm_usable = 1;
+            const int err = checkasm_perf_validate_start(&checkasm_perf);
+            checkasm_set_signal_handler_state(0);
+            if (!err)
+                return 0;
+        } else {
+            fprintf(stderr, "checkasm: unable to access rdpmc cycle counter\n");
+        }
+        checkasm_perf.rdpmc = NULL;
+    }
+#endif
+
 #if defined(CHECKASM_PERF_ASM) && CHECKASM_HAVE_LONGJMP
     if (!checkasm_save_context(checkasm_context)) {
         /* Try calling the asm timer to see if it works */
@@ -125,6 +163,37 @@ COLD int checkasm_perf_init(void)
     return 0;
 }
 
+COLD void checkasm_perf_fork_child(void)
+{
+#if HAVE_LINUX_PERF
+    if (checkasm_perf_reopen_linux())
+        fprintf(stderr, "checkasm: unable to re-open the perf timer after fork\n");
+    if (checkasm_perf_reopen_counters_linux())
+        fprintf(stderr, "checkasm: unable to re-open the perf counters after fork\n");
+#endif
+#if defined(CHECKASM_PERF_RDPMC) && HAVE_LINUX_PERF
+    /* Falls back to rdtsc, instead of reading a counter that isn't ours */
+    if (checkasm_perf.rdpmc && checkasm_perf_reopen_rdpmc())
+        checkasm_perf.rdpmc = NULL;
+#endif
+}
+
+COLD int checkasm_perf_init_counters(void)
+{
+#if HAVE_LINUX_PERF
+    if (!checkasm_perf_init_counters_linux(&checkasm_perf)) {
+  #ifdef CHECKASM_PERF_ASM
+        /* The unrolled asm loop never calls perf.start/stop() */
+        checkasm_perf.asm_usable = 0;
+  #endif
+        return 0;
+    }
+#endif
+
+    fprintf(stderr, "checkasm: performance counters are not available\n");
+    return 1;
+}
+
 COLD int checkasm_perf_validate_start(const CheckasmPerf *perf)
 {
     /* Try to make the loop long enough to be sure that the timer should
@@ -173,7 +242,8 @@ COLD int checkasm_perf_validate_start_stop(const CheckasmPerf *perf)
 }
 
 /* Measure the overhead of the timing code */
-COLD void checkasm_measure_nop_cycles(CheckasmMeasurement *meas, uint64_t target_cycles)
+static COLD void measure_nop_cycles(CheckasmMeasurement *meas, uint64_t target_cycles,
+                                    const int serial)
 {
     CheckasmStats stats;
     checkasm_stats_reset(&stats);
@@ -194,7 +264,12 @@ COLD void checkasm_measure_nop_cycles(CheckasmMeasurement *meas, uint64_t target
             checkasm_noop(NULL);
 
         /* Measure the overhead of the timing code (in cycles) */
-        CHECKASM_PERF_BENCH(count, cycles, alternate(ptr0, ptr1));
+        if (serial) {
+            CHECKASM_PERF_BENCH_SERIAL(count, cycles, CHECKASM_SINK_VOID,
+                                       alternate(ptr0, ptr1));
+        } else {
+            CHECKASM_PERF_BENCH(count, cycles, alternate(ptr0, ptr1));
+        }
         total_cycles += cycles;
 
         checkasm_stats_add(&stats, (CheckasmSample) { cycles, count });
@@ -206,6 +281,42 @@ COLD void checkasm_measure_nop_cycles(CheckasmMeasurement *meas, uint64_t target
     checkasm_measurement_update(meas, stats);
 }
 
+COLD void checkasm_measure_nop_cycles(CheckasmMeasurement *meas, uint64_t target_cycles)
+{
+    measure_nop_cycles(meas, target_cycles, 0);
+}
+
+/* Same, with the loop used for measuring latency */
+COLD void checkasm_measure_nop_cycles_serial(CheckasmMeasurement *meas,
+                                             uint64_t             target_cycles)
+{
+    measure_nop_cycles(meas, target_cycles, 1);
+}
+
+/* Measure the overhead of timing a single call, as done for cold caches */
+COLD void checkasm_measure_nop_cycles_single(CheckasmMeasurement *meas)
+{
+    CheckasmStats stats;
+    checkasm_stats_reset(&stats);
+
+    void (*const bench_func)(void *) = checkasm_noop;
+    void *const ptr                  = (void *) 0x1000;
+
+    const CheckasmPerf perf = checkasm_perf;
+    (void) perf;
+
+    for (int i = 0; i < 128; i++) {
+        int      count  = 1;
+        uint64_t cycles = 0;
+        CHECKASM_PERF_BENCH(count, cycles, ptr);
+        checkasm_stats_add(&stats, (CheckasmSample) { cycles, count });
+    }
+
+    /* Coarse timers may not be able to time a single call at all */
+    if (stats.nb_samples)
+        checkasm_measurement_update(meas, stats);
+}
+
 COLD void checkasm_measure_perf_scale(CheckasmMeasurement *meas)
 {
     const CheckasmPerf perf = checkasm_perf;
@@ -254,3 +365,111 @@ COLD void checkasm_measure_perf_scale(CheckasmMeasurement *meas)
 
     checkasm_measurement_update(meas, stats);
 }
+
+/* Enough independent accumulators to keep all vector pipelines busy (even with
+ * 512-bit vectors), with PEAK_CHAIN multiply-adds per load and store so those
+ * aren't the bottleneck */
+#define PEAK_LANES 256
+#define PEAK_CHAIN 4
+#define PEAK_ITERS 512
+
+/* Inlined into each of the instruction set specific versions below */
+static ALWAYS_INLINE double peak_ops(float *const acc, const float mul, const float add,
+                                     const int fused)
+{
+    /* Keep the best of several passes, to filter out interrupts and
+     * frequency ramp-up */
+    const uint64_t target_nsec = 10000000; /* 10 ms */
+    double         best        = 0.0;
+    uint64_t       total       = 0;
+
+    for (int pass = 0; pass < 4 || total < target_nsec; pass++) {
+        uint64_t nsec = checkasm_gettime_nsec();
+        for (int i = 0; i < PEAK_ITERS; i++) {
+            /* Written out, since GCC only vectorizes the innermost loop */
+            for (int j = 0; j < PEAK_LANES; j++) {
+                float x = acc[j];
+                if (fused) {
+                    x = fmaf(x, mul, add);
+                    x = fmaf(x, mul, add);
+                    x = fmaf(x, mul, add);
+                    x = fmaf(x, mul, add);
+                } else {
+                    x = x * mul + add;
+                    x = x * mul + add;
+                    x = x * mul + add;
+                    x = x * mul + add;
+                }
+                acc[j] = x;
+            }
+        }
+        nsec = checkasm_gettime_nsec_diff(nsec);
+        total += nsec;
+        if (nsec)
+            best = fmax(best, 2.0 * PEAK_CHAIN * PEAK_LANES * PEAK_ITERS / nsec);
+    }
+
+    return best;
+}
+
+/* Not marked as cold, since GCC doesn't vectorize functions optimized for size */
+static double peak_ops_c(float *const acc, const float mul, const float add)
+{
+    return peak_ops(acc, mul, add, 0);
+}
+
+#if ARCH_X86 && __has_attribute(target)
+  #define HAVE_PEAK_OPS_X86 1
+
+static __attribute__((target("avx2,fma"))) double
+peak_ops_avx2(float *const acc, const float mul, const float add)
+{
+    return peak_ops(acc, mul, add, 1);
+}
+
+static __attribute__((target("avx512f,fma"))) double
+peak_ops_avx512(float *const acc, const float mul, const float add)
+{
+    return peak_ops(acc, mul, add, 1);
+}
+#else
+  #define HAVE_PEAK_OPS_X86 0
+#endif
+
+double checkasm_measure_peak_ops(const char **const isa)
+{
+    float acc[PEAK_LANES];
+    for (int j = 0; j < PEAK_LANES; j++)
+        acc[j] = (float) j;
+
+    /* Converges to a fixed point, so the values never become denormal */
+    volatile float mul_v = 0.5f, add_v = 1.0f;
+    const float    mul = mul_v, add = add_v;
+
+    double best;
+#if HAVE_PEAK_OPS_X86
+    switch (checkasm_get_x86_simd()) {
+    case CHECKASM_X86_SIMD_AVX512:
+        *isa = "AVX-512";
+        best = peak_ops_avx512(acc, mul, add);
+        break;
+    case CHECKASM_X86_SIMD_AVX2:
+        *isa = "AVX2";
+        best = peak_ops_avx2(acc, mul, add);
+        break;
+    default:
+        *isa = "baseline";
+        best = peak_ops_c(acc, mul, add);
+        break;
+    }
+#else
+    *isa = "baseline";
+    best = peak_ops_c(acc, mul, add);
+#endif
+
+    volatile float sink = 0.0f;
+    for (int j = 0; j < PEAK_LANES; j++)
+        sink += acc[j];
+    (void) sink;
+    return best;
+}
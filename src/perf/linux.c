@@ -35,7 +35,9 @@
   #endif
 
   #include <linux/perf_event.h>
+  #include <stddef.h>
   #include <sys/ioctl.h>
+  #include <sys/mman.h>
   #include <sys/syscall.h>
   #include <unistd.h>
 
@@ -58,7 +60,7 @@ static uint64_t perf_stop(uint64_t t)
     return t;
 }
 
-COLD int checkasm_perf_init_linux(CheckasmPerf *perf)
+static int open_sysfd(void)
 {
     struct perf_event_attr attr = {
         .type           = PERF_TYPE_HARDWARE,
@@ -72,13 +74,18 @@ COLD int checkasm_perf_init_linux(CheckasmPerf *perf)
 #endif
     };
 
+    perf_sysfd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
     if (perf_sysfd == -1) {
-        perf_sysfd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
-        if (perf_sysfd == -1) {
-            perror("perf_event_open");
-            return 1;
-        }
+        perror("perf_event_open");
+        return 1;
     }
+    return 0;
+}
+
+COLD int checkasm_perf_init_linux(CheckasmPerf *perf)
+{
+    if (perf_sysfd == -1 && open_sysfd())
+        return 1;
 
     perf->start = perf_start;
     perf->stop  = perf_stop;
@@ -87,4 +94,247 @@ COLD int checkasm_perf_init_linux(CheckasmPerf *perf)
     return checkasm_perf_validate_start_stop(perf);
 }
 
+/* Like rdpmc, the event only counts the task that opened it */
+COLD int checkasm_perf_reopen_linux(void)
+{
+    if (perf_sysfd == -1)
+        return 0;
+    close(perf_sysfd);
+    return open_sysfd();
+}
+
+  #ifdef CHECKASM_PERF_RDPMC
+
+static CheckasmRdpmc                 rdpmc;
+static struct perf_event_mmap_page *rdpmc_page;
+static int                          rdpmc_fd = -1;
+
+static void close_rdpmc(void)
+{
+    if (rdpmc_page)
+        munmap(rdpmc_page, sysconf(_SC_PAGESIZE));
+    if (rdpmc_fd != -1)
+        close(rdpmc_fd);
+    rdpmc_page = NULL;
+    rdpmc_fd   = -1;
+}
+
+/* Open the cycle counter of the calling task, and map its control page */
+static int open_rdpmc(void)
+{
+    struct perf_event_attr attr = {
+        .type           = PERF_TYPE_HARDWARE,
+        .size           = sizeof(struct perf_event_attr),
+        .config         = PERF_COUNT_HW_CPU_CYCLES,
+        .exclude_kernel = 1,
+        .exclude_hv     = 1,
+    };
+
+    /* Failure is not an error here, we silently fall back to rdtsc */
+    rdpmc_fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (rdpmc_fd == -1)
+        return 1;
+
+    void *const map
+        = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, rdpmc_fd, 0);
+    if (map == MAP_FAILED) {
+        close_rdpmc();
+        return 1;
+    }
+
+    rdpmc_page = map;
+    if (!rdpmc_page->cap_user_rdpmc || !rdpmc_page->index) {
+        close_rdpmc();
+        return 1;
+    }
+
+    rdpmc.lock   = &rdpmc_page->lock;
+    rdpmc.index  = &rdpmc_page->index;
+    rdpmc.offset = (const volatile int64_t *) &rdpmc_page->offset;
+    rdpmc.width  = rdpmc_page->pmc_width;
+    return 0;
+}
+
+COLD int checkasm_perf_init_rdpmc(CheckasmPerf *perf)
+{
+    if (!rdpmc_page && open_rdpmc())
+        return 1;
+
+    perf->rdpmc = &rdpmc;
+    return 0;
+}
+
+/* The event only counts the task that opened it, so a forked child reading the
+ * inherited mapping would see the parent's (idle) counter */
+COLD int checkasm_perf_reopen_rdpmc(void)
+{
+    close_rdpmc();
+    return open_rdpmc();
+}
+
+  #endif /* CHECKASM_PERF_RDPMC */
+
+typedef struct PerfEvent {
+    const char *name;
+    uint32_t    type;
+    uint64_t    config;
+} PerfEvent;
+
+  #define HW_CACHE(cache, op, result)                                                    \
+      (PERF_COUNT_HW_CACHE_##cache | (PERF_COUNT_HW_CACHE_OP_##op << 8)                  \
+       | (PERF_COUNT_HW_CACHE_RESULT_##result << 16))
+
+static const PerfEvent hw_events[] = {
+    { "cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES     },
+    { "refCycles",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_REF_CPU_CYCLES },
+    { "instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS   },
+    { "branchMisses",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES  },
+    { "l1dReadMisses", PERF_TYPE_HW_CACHE, HW_CACHE(L1D, READ, MISS)    },
+    { "llcMisses",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES   },
+};
+
+/* Fallback for systems without a (virtualized) PMU */
+static const PerfEvent sw_events[] = {
+    { "taskClock",       PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK       },
+    { "pageFaults",      PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS      },
+    { "contextSwitches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+};
+
+static const PerfEvent *group_events; /* table the group was opened from */
+static int              group_nb_events;
+static int              group_fd = -1;
+static int              group_fds[CHECKASM_PERF_MAX_COUNTERS];
+static uint64_t (*timer_start)(void);
+static uint64_t (*timer_stop)(uint64_t);
+
+/* Layout of a read() on the group leader */
+typedef struct GroupValues {
+    uint64_t nr;
+    uint64_t time_enabled;
+    uint64_t time_running;
+    uint64_t values[CHECKASM_PERF_MAX_COUNTERS];
+} GroupValues;
+
+static int read_group(uint64_t *const out)
+{
+    GroupValues gv;
+    if (read(group_fd, &gv, sizeof(gv)) < (long) offsetof(GroupValues, values)
+        || gv.nr > CHECKASM_PERF_MAX_COUNTERS || !gv.time_running)
+        return 1;
+
+    /* Extrapolate if the group was multiplexed with other events */
+    const double scale = (double) gv.time_enabled / gv.time_running;
+    for (uint64_t i = 0; i < gv.nr; i++)
+        out[i] = gv.time_running < gv.time_enabled ? (uint64_t) (gv.values[i] * scale)
+                                                   : gv.values[i];
+    return 0;
+}
+
+static uint64_t counters_start(void)
+{
+    ioctl(group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return timer_start();
+}
+
+static uint64_t counters_stop(uint64_t t)
+{
+    t = timer_stop(t);
+    ioctl(group_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    if (read_group(checkasm_perf_counters.values))
+        memset(checkasm_perf_counters.values, 0, sizeof(checkasm_perf_counters.values));
+    return t;
+}
+
+static void close_group(void)
+{
+    for (int i = checkasm_perf_counters.nb_counters - 1; i >= 0; i--)
+        close(group_fds[i]);
+    checkasm_perf_counters.nb_counters = 0;
+    group_fd                           = -1;
+}
+
+/* Open as many of the given events as possible as a single counter group */
+static int open_group(const PerfEvent *const events, const int nb_events)
+{
+    CheckasmPerfCounters *const counters = &checkasm_perf_counters;
+    counters->nb_counters                = 0;
+    group_fd                             = -1;
+
+    for (int i = 0; i < nb_events; i++) {
+        struct perf_event_attr attr = {
+            .type           = events[i].type,
+            .size           = sizeof(struct perf_event_attr),
+            .config         = events[i].config,
+            .disabled       = group_fd == -1,
+            .exclude_kernel = 1,
+            .exclude_hv     = 1,
+  #if !ARCH_X86
+            .exclude_guest = 1,
+  #endif
+            .read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                         | PERF_FORMAT_TOTAL_TIME_RUNNING,
+        };
+
+        const int fd = (int) syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+        if (fd == -1)
+            continue;
+        if (group_fd == -1)
+            group_fd = fd;
+        group_fds[counters->nb_counters]         = fd;
+        counters->names[counters->nb_counters++] = events[i].name;
+    }
+
+    if (group_fd == -1)
+        return 1;
+
+    /* Make sure the group can actually be scheduled */
+    uint64_t values[CHECKASM_PERF_MAX_COUNTERS];
+    ioctl(group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    for (int i = 0; i < 1000; i++)
+        checkasm_noop(NULL);
+    ioctl(group_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    if (read_group(values)) {
+        close_group();
+        return 1;
+    }
+
+    group_events    = events;
+    group_nb_events = nb_events;
+    return 0;
+}
+
+COLD int checkasm_perf_init_counters_linux(CheckasmPerf *perf)
+{
+    if (group_fd == -1 && open_group(hw_events, ARRAY_SIZE(hw_events))
+        && open_group(sw_events, ARRAY_SIZE(sw_events)))
+        return 1;
+
+    if (perf->start != counters_start) {
+        timer_start = perf->start;
+        timer_stop  = perf->stop;
+        perf->start = counters_start;
+        perf->stop  = counters_stop;
+    }
+    return 0;
+}
+
+/* Per-task as well. A child that can't open the same group gets no counters,
+ * rather than values the parent would report under the wrong names */
+COLD int checkasm_perf_reopen_counters_linux(void)
+{
+    if (group_fd == -1)
+        return 0;
+
+    const int nb_counters = checkasm_perf_counters.nb_counters;
+    close_group();
+    if (!open_group(group_events, group_nb_events)
+        && checkasm_perf_counters.nb_counters == nb_counters)
+        return 0;
+
+    if (group_fd != -1)
+        close_group();
+    return 1;
+}
+
 #endif /* HAVE_LINUX_PERF */
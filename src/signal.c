@@ -29,6 +29,7 @@
 #include <assert.h>
 #include <signal.h>
 #include <stdarg.h>
+#include <stdint.h>
 
 #include "checkasm_config.h"
 
@@ -47,6 +48,10 @@ checkasm_jmp_buf checkasm_context;
 
 static volatile sig_atomic_t sig; // SIG_ATOMIC_MAX = signal handling enabled
 
+/* Faulting address and access type ('r' or 'w', if known) of the last signal */
+static volatile uintptr_t    fault_addr;
+static volatile sig_atomic_t fault_access;
+
 volatile sig_atomic_t checkasm_interrupted;
 
 void checkasm_set_signal_handler_state(const int enabled)
@@ -88,6 +93,13 @@ static LONG NTAPI signal_handler(EXCEPTION_POINTERS *const e)
         case EXCEPTION_IN_PAGE_ERROR:         s = SIGBUS; break;
         default:                              return EXCEPTION_CONTINUE_SEARCH;
         }
+        fault_addr   = 0;
+        fault_access = 0;
+        if (e->ExceptionRecord->ExceptionCode == EXCEPTION_ACCESS_VIOLATION) {
+            const ULONG_PTR *info = e->ExceptionRecord->ExceptionInformation;
+            fault_addr   = info[1];
+            fault_access = info[0] == 0 ? 'r' : info[0] == 1 ? 'w' : 0;
+        }
         sig = s;
         checkasm_load_context(checkasm_context);
     }
@@ -95,9 +107,9 @@ static LONG NTAPI signal_handler(EXCEPTION_POINTERS *const e)
 }
   #endif
 
-#elif HAVE_SIGACTION && defined(SA_RESETHAND)
+#elif HAVE_SIGACTION && defined(SA_RESETHAND) && defined(SA_SIGINFO)
 
-static void signal_handler(int s);
+static void signal_handler(int s, siginfo_t *info, void *context);
 
 static const struct sigaction interrupt_handler_act = {
     .sa_handler = interrupt_handler,
@@ -105,14 +117,17 @@ static const struct sigaction interrupt_handler_act = {
 };
 
 static const struct sigaction signal_handler_act = {
-    .sa_handler = signal_handler,
-    .sa_flags   = SA_RESETHAND,
+    .sa_sigaction = signal_handler,
+    .sa_flags     = SA_RESETHAND | SA_SIGINFO,
 };
 
-static void signal_handler(const int s)
+static void signal_handler(const int s, siginfo_t *const info, void *const context)
 {
+    (void) context;
     if (sig == SIG_ATOMIC_MAX) {
-        sig = s;
+        fault_addr   = (uintptr_t) info->si_addr;
+        fault_access = 0; /* not portably known */
+        sig          = s;
         sigaction(s, &signal_handler_act, NULL);
         checkasm_load_context(checkasm_context);
     }
@@ -122,7 +137,8 @@ static void signal_handler(const int s)
 static void signal_handler(const int s)
 {
     if (sig == SIG_ATOMIC_MAX) {
-        sig = s;
+        fault_addr = 0;
+        sig        = s;
         signal(s, signal_handler);
         checkasm_load_context(checkasm_context);
     }
@@ -141,7 +157,7 @@ COLD void checkasm_set_signal_handlers(void)
   #endif
     signal(SIGINT, interrupt_handler);
     signal(SIGTERM, interrupt_handler);
-#elif HAVE_SIGACTION && defined(SA_RESETHAND)
+#elif HAVE_SIGACTION && defined(SA_RESETHAND) && defined(SA_SIGINFO)
 #ifdef SIGBUS
     sigaction(SIGBUS, &signal_handler_act, NULL);
 #endif
@@ -164,15 +180,24 @@ COLD void checkasm_set_signal_handlers(void)
     handlers_set = 1;
 }
 
+/* More specific description for memory access errors */
+static const char *fault_desc(const char *const desc)
+{
+    if (!fault_addr)
+        return desc;
+    const char *const oob = checkasm_guard_fault_desc(fault_addr, fault_access);
+    return oob ? oob : desc;
+}
+
 const char *checkasm_get_last_signal_desc(void)
 {
     switch (sig) {
     case SIGFPE:  return "fatal arithmetic error";
     case SIGILL:  return "illegal instruction";
 #ifdef SIGBUS
-    case SIGBUS:  return "bus error";
+    case SIGBUS:  return fault_desc("bus error");
 #endif
-    case SIGSEGV: return "segmentation fault";
+    case SIGSEGV: return fault_desc("segmentation fault");
     case SIGINT:  return "interrupted";
     case SIGTERM: return "terminated";
     default:      return NULL;
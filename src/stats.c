@@ -99,11 +99,13 @@ CheckasmVar checkasm_var_div(CheckasmVar a, CheckasmVar b)
     };
 }
 
-CheckasmVar checkasm_stats_estimate(const CheckasmStats *const stats)
-{
-    if (!stats->nb_samples)
-        return checkasm_var_const(0.0);
+typedef struct Moments {
+    double mean, var; /* of the log-transformed samples */
+    double neff;      /* effective number of samples */
+} Moments;
 
+static Moments stats_moments(const CheckasmStats *const stats)
+{
     /* Compute mean and variance */
     double sum = 0.0, sum2 = 0.0, sum_w2 = 0.0;
     int    count = 0;
@@ -127,5 +129,100 @@ CheckasmVar checkasm_stats_estimate(const CheckasmStats *const stats)
         var = 1.0 / count;
     }
 
-    return (CheckasmVar) { .lmean = mean, .lvar  = var };
+    /* Kish's effective sample size for weighted samples */
+    const double neff = (double) count * count / sum_w2;
+    return (Moments) { .mean = mean, .var = var, .neff = neff };
+}
+
+CheckasmVar checkasm_stats_estimate(const CheckasmStats *const stats)
+{
+    if (!stats->nb_samples)
+        return checkasm_var_const(0.0);
+
+    const Moments m = stats_moments(stats);
+    return (CheckasmVar) { .lmean = m.mean, .lvar  = m.var };
+}
+
+double checkasm_stats_precision(const CheckasmStats *const stats)
+{
+    if (!stats->nb_samples)
+        return INFINITY;
+
+    const Moments m = stats_moments(stats);
+    return sqrt(exp(m.var / m.neff) - 1.0);
+}
+
+static int hist_index(const uint64_t value)
+{
+    const uint64_t sub = 1 << CHECKASM_HIST_SUB_BITS;
+    if (value < sub)
+        return (int) value;
+
+    int exp = CHECKASM_HIST_SUB_BITS;
+    while (exp < 63 && value >> (exp + 1))
+        exp++;
+
+    const int shift = exp - CHECKASM_HIST_SUB_BITS;
+    return (shift + 1) << CHECKASM_HIST_SUB_BITS | (int) ((value >> shift) & (sub - 1));
+}
+
+uint64_t checkasm_histogram_bucket_start(const int idx)
+{
+    const int sub   = 1 << CHECKASM_HIST_SUB_BITS;
+    const int shift = (idx >> CHECKASM_HIST_SUB_BITS) - 1;
+    if (shift < 0)
+        return idx;
+    return (uint64_t) (sub + (idx & (sub - 1))) << shift;
+}
+
+uint64_t checkasm_histogram_bucket_width(const int idx)
+{
+    const int shift = (idx >> CHECKASM_HIST_SUB_BITS) - 1;
+    return shift < 0 ? 1 : (uint64_t) 1 << shift;
+}
+
+void checkasm_histogram_add(CheckasmHistogram *const hist, const uint64_t value)
+{
+    uint32_t *const bucket = &hist->buckets[hist_index(value)];
+    if (*bucket == UINT32_MAX)
+        return; /* saturated */
+    (*bucket)++;
+    hist->count++;
+    if (value > hist->max)
+        hist->max = value;
+}
+
+void checkasm_histogram_merge(CheckasmHistogram *const dst,
+                              const CheckasmHistogram *const src)
+{
+    for (int i = 0; i < CHECKASM_HIST_BUCKETS; i++) {
+        const uint64_t sum = (uint64_t) dst->buckets[i] + src->buckets[i];
+        dst->count += (sum > UINT32_MAX ? UINT32_MAX : sum) - dst->buckets[i];
+        dst->buckets[i] = sum > UINT32_MAX ? UINT32_MAX : (uint32_t) sum;
+    }
+    if (src->max > dst->max)
+        dst->max = src->max;
+}
+
+double checkasm_histogram_quantile(const CheckasmHistogram *const hist, const double q)
+{
+    if (!hist->count)
+        return 0.0;
+
+    /* Rank of the requested sample, counting from 1 */
+    uint64_t rank = (uint64_t) ceil(q * hist->count);
+    if (rank < 1)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < CHECKASM_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            const double mid = checkasm_histogram_bucket_start(i)
+                             + 0.5 * (checkasm_histogram_bucket_width(i) - 1);
+            return fmin(mid, (double) hist->max);
+        }
+    }
+
+    return (double) hist->max;
 }
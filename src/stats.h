@@ -27,11 +27,14 @@
 #ifndef CHECKASM_STATS_H
 #define CHECKASM_STATS_H
 
+#include "checkasm_config.h"
 #include <assert.h>
 #include <math.h>
 #include <stdint.h>
 #include <string.h>
 
+#include "checkasm/attributes.h"
+
 typedef struct CheckasmVar {
     double lmean, lvar; /* log mean and variance */
 } CheckasmVar;
@@ -119,10 +122,20 @@ static inline void checkasm_stats_count_grow(CheckasmStats *const stats, uint64_
 
 CheckasmVar checkasm_stats_estimate(const CheckasmStats *stats);
 
+/* Relative standard error of the mean of checkasm_stats_estimate(); unlike its
+ * variance, this shrinks as more samples are added */
+double checkasm_stats_precision(const CheckasmStats *stats);
+
 typedef struct CheckasmMeasurement {
     CheckasmVar   product;
     int           nb_measurements;
     CheckasmStats stats; /* last measurement run */
+
+    /* Log estimates of previous iterations, see checkasm_measurement_iterate() */
+    double iter_lsum, iter_lsq;
+    int    nb_iters;
+    int    iter_start;  /* nb_measurements at the start of the current iteration */
+    double iter_lstart; /* product.lmean at the start of the current iteration */
 } CheckasmMeasurement;
 
 static inline void checkasm_measurement_init(CheckasmMeasurement *measurement)
@@ -130,6 +143,25 @@ static inline void checkasm_measurement_init(CheckasmMeasurement *measurement)
     measurement->product          = checkasm_var_const(1.0);
     measurement->nb_measurements  = 0;
     measurement->stats.nb_samples = 0;
+    measurement->iter_lsum = measurement->iter_lsq = measurement->iter_lstart = 0.0;
+    measurement->nb_iters = measurement->iter_start = 0;
+}
+
+/* Close the current iteration, so that subsequent measurements are accumulated
+ * as part of a new one (with a different seed). The spread between iterations
+ * is then included in the variance of checkasm_measurement_result() */
+static inline void checkasm_measurement_iterate(CheckasmMeasurement *measurement)
+{
+    const int nb = measurement->nb_measurements - measurement->iter_start;
+    if (!nb)
+        return;
+
+    const double lmean = (measurement->product.lmean - measurement->iter_lstart) / nb;
+    measurement->iter_lsum += lmean;
+    measurement->iter_lsq += lmean * lmean;
+    measurement->nb_iters++;
+    measurement->iter_start  = measurement->nb_measurements;
+    measurement->iter_lstart = measurement->product.lmean;
 }
 
 static inline void checkasm_measurement_update(CheckasmMeasurement *measurement,
@@ -143,10 +175,164 @@ static inline void checkasm_measurement_update(CheckasmMeasurement *measurement,
            sizeof(stats.samples[0]) * stats.nb_samples);
 }
 
+/* Amount of work done per function call (see checkasm_bench_set_work() and
+ * checkasm_bench_set_ops()), accumulated over multiple measurements as a
+ * geometric mean */
+typedef struct CheckasmWork {
+    double lbytes, lelems, lops;       /* sum of log(work) over all measurements */
+    int    nb_bytes, nb_elems, nb_ops; /* number of measurements with known work */
+} CheckasmWork;
+
+static inline void checkasm_work_update(CheckasmWork *const work, const uint64_t bytes,
+                                        const uint64_t elems, const uint64_t ops)
+{
+    if (bytes) {
+        work->lbytes += log((double) bytes);
+        work->nb_bytes++;
+    }
+    if (elems) {
+        work->lelems += log((double) elems);
+        work->nb_elems++;
+    }
+    if (ops) {
+        work->lops += log((double) ops);
+        work->nb_ops++;
+    }
+}
+
+/* Clock frequency and temperature sampled around each measurement (see
+ * cfg.telemetry), accumulated over multiple measurements */
+typedef struct CheckasmTelemetry {
+    double lratio;               /* sum of log(clock ratio) over all measurements */
+    double ratio_min, ratio_max; /* over all start and end samples */
+    double temp_max;             /* in degrees Celsius */
+    int    nb_ratios, nb_temps;  /* number of measurements with known values */
+    int    reruns;   /* measurements repeated due to a clock transition */
+    int    unstable; /* measurements still in transition after all reruns */
+} CheckasmTelemetry;
+
+/* Adds a measurement that started and ended at the given clock ratios (0 if
+ * unknown) and reached the given temperature (NAN if unknown) */
+static inline void checkasm_telemetry_update(CheckasmTelemetry *const t,
+                                             const double start, const double end,
+                                             const double temp)
+{
+    if (start > 0.0 && end > 0.0) {
+        const double lo = fmin(start, end), hi = fmax(start, end);
+        t->lratio += 0.5 * (log(start) + log(end));
+        t->ratio_min = t->nb_ratios ? fmin(t->ratio_min, lo) : lo;
+        t->ratio_max = t->nb_ratios ? fmax(t->ratio_max, hi) : hi;
+        t->nb_ratios++;
+    }
+    if (!isnan(temp)) {
+        t->temp_max = t->nb_temps ? fmax(t->temp_max, temp) : temp;
+        t->nb_temps++;
+    }
+}
+
+/* Log speedups over the reference version, from batches of both versions timed
+ * back to back (see cfg.bench_paired), accumulated over multiple measurements */
+typedef struct CheckasmPaired {
+    double lsum, lsq; /* sum of log(ref / new) and of its square */
+    int    nb;        /* number of batch pairs */
+} CheckasmPaired;
+
+static inline void checkasm_paired_add(CheckasmPaired *const p, const double ldiff)
+{
+    p->lsum += ldiff;
+    p->lsq += ldiff * ldiff;
+    p->nb++;
+}
+
+static inline void checkasm_paired_merge(CheckasmPaired *const dst,
+                                         const CheckasmPaired src)
+{
+    dst->lsum += src.lsum;
+    dst->lsq += src.lsq;
+    dst->nb += src.nb;
+}
+
+/* Speedup as the mean log difference, with the variance of that mean. Since
+ * both versions share any drift within a pair, this is much tighter than
+ * dividing two independent estimates */
+static inline CheckasmVar checkasm_paired_result(const CheckasmPaired p)
+{
+    if (!p.nb)
+        return checkasm_var_const(1.0);
+
+    const double lmean = p.lsum / p.nb;
+    const double lsq   = fmax(p.lsq - p.nb * lmean * lmean, 0.0);
+    const double lvar  = p.nb > 1 ? lsq / (p.nb - 1) : 0.0;
+    return (CheckasmVar) { lmean, lvar / p.nb };
+}
+
+/* Log-bucketed histogram of individually timed calls, for tail latencies. Each
+ * power of two is split into 2^CHECKASM_HIST_SUB_BITS linear sub-buckets, so
+ * the relative error of any quantile is bounded by ~3%, while values below
+ * 2^CHECKASM_HIST_SUB_BITS are stored exactly */
+#define CHECKASM_HIST_SUB_BITS 4
+#define CHECKASM_HIST_BUCKETS  ((65 - CHECKASM_HIST_SUB_BITS) << CHECKASM_HIST_SUB_BITS)
+
+typedef struct CheckasmHistogram {
+    uint64_t count, max;
+    uint32_t buckets[CHECKASM_HIST_BUCKETS];
+} CheckasmHistogram;
+
+CHECKASM_SELF_API void checkasm_histogram_add(CheckasmHistogram *hist, uint64_t value);
+void checkasm_histogram_merge(CheckasmHistogram *dst, const CheckasmHistogram *src);
+
+/* Smallest value that falls into the given bucket, and the bucket's width */
+CHECKASM_SELF_API uint64_t checkasm_histogram_bucket_start(int idx);
+CHECKASM_SELF_API uint64_t checkasm_histogram_bucket_width(int idx);
+
+/* Value at quantile q (0.0 - 1.0), as the midpoint of the enclosing bucket */
+CHECKASM_SELF_API double checkasm_histogram_quantile(const CheckasmHistogram *hist,
+                                                     double q);
+
+/* Totals of additional performance counters (see checkasm_perf_counters) */
+#define CHECKASM_PERF_MAX_COUNTERS 8
+
+typedef struct CheckasmCounters {
+    uint64_t iters; /* number of function calls counted */
+    uint64_t values[CHECKASM_PERF_MAX_COUNTERS];
+} CheckasmCounters;
+
+static inline void checkasm_counters_add(CheckasmCounters *const dst,
+                                         const CheckasmCounters src)
+{
+    dst->iters += src.iters;
+    for (int i = 0; i < CHECKASM_PERF_MAX_COUNTERS; i++)
+        dst->values[i] += src.values[i];
+}
+
+/* Number of timed batches seen and rejected by checkasm_bench_trim() */
+typedef struct CheckasmRejects {
+    uint64_t batches, rejected;
+} CheckasmRejects;
+
+static inline void checkasm_rejects_add(CheckasmRejects *const dst,
+                                        const CheckasmRejects src)
+{
+    dst->batches += src.batches;
+    dst->rejected += src.rejected;
+}
+
 static inline CheckasmVar
-checkasm_measurement_result(const CheckasmMeasurement measurement)
+checkasm_measurement_result(CheckasmMeasurement measurement)
 {
-    return checkasm_var_pow(measurement.product, 1.0 / measurement.nb_measurements);
+    CheckasmVar result
+        = checkasm_var_pow(measurement.product, 1.0 / measurement.nb_measurements);
+
+    checkasm_measurement_iterate(&measurement);
+    const int n = measurement.nb_iters;
+    if (n > 1) {
+        /* Standard error of the mean, if the iterations disagree by more
+         * than their individual measurements would suggest */
+        const double lmean = measurement.iter_lsum / n;
+        const double lvar  = (measurement.iter_lsq - n * lmean * lmean) / (n - 1);
+        result.lvar        = fmax(result.lvar, lvar / n);
+    }
+    return result;
 }
 
 #endif /* CHECKASM_STATS_H */
@@ -0,0 +1,392 @@
+/*
+ * Copyright © 2025, Niklas Haas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "checkasm_config.h"
+
+#if HAVE_SCHED_GETCPU
+  /* _GNU_SOURCE is required for sched_getcpu on glibc. */
+  #ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+  #endif
+  #include <sched.h>
+#endif
+#if HAVE_MLOCKALL
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+#if HAVE_MLOCKALL || HAVE_SETPRIORITY
+  #include <sys/resource.h>
+#endif
+#ifdef __linux__
+  #include <time.h>
+#endif
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+#include "telemetry.h"
+
+#define PATH_LEN 512
+
+static struct {
+    const char *root;
+    int         cpu;                /* CPU the frequency files belong to */
+    double      ref_khz;            /* reference frequency of that CPU, or 0 */
+    char        cur_freq[PATH_LEN]; /* current frequency, in kHz */
+    char        temp[PATH_LEN];     /* temperature of the thermal zone, in m°C */
+    char        zone[32];           /* type of the thermal zone */
+    char        desc[128];
+} telemetry;
+
+static int read_double(const char *const path, double *const out)
+{
+    FILE *const f = fopen(path, "r");
+    if (!f)
+        return 1;
+    const int ret = fscanf(f, "%lf", out) != 1;
+    fclose(f);
+    return ret;
+}
+
+static int read_line(const char *const path, char *const buf, const int size)
+{
+    FILE *const f = fopen(path, "r");
+    if (!f)
+        return 1;
+    if (!fgets(buf, size, f))
+        buf[0] = '\0';
+    fclose(f);
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+static int current_cpu(void)
+{
+#if HAVE_SCHED_GETCPU
+    const int cpu = sched_getcpu();
+    return cpu >= 0 ? cpu : 0;
+#else
+    return 0;
+#endif
+}
+
+/* Locate the cpufreq files of the given CPU */
+static void open_cpu(const int cpu)
+{
+    static const char *const ref_names[] = {
+        "base_frequency",   /* intel_pstate, matches the TSC frequency */
+        "cpuinfo_max_freq", /* everything else */
+    };
+
+    telemetry.cpu     = cpu;
+    telemetry.ref_khz = 0.0;
+    snprintf(telemetry.cur_freq, sizeof(telemetry.cur_freq),
+             "%s/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", telemetry.root, cpu);
+
+    for (size_t i = 0; i < ARRAY_SIZE(ref_names); i++) {
+        char   path[PATH_LEN];
+        double khz;
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%d/cpufreq/%s",
+                 telemetry.root, cpu, ref_names[i]);
+        if (!read_double(path, &khz) && khz > 0.0) {
+            telemetry.ref_khz = khz;
+            break;
+        }
+    }
+}
+
+/* Use the first thermal zone, unless one belongs to the CPU package */
+static void open_thermal(void)
+{
+    static const char *const cpu_zones[] = { "x86_pkg_temp", "cpu", "soc" };
+
+    telemetry.temp[0] = telemetry.zone[0] = '\0';
+    for (int i = 0;; i++) {
+        char path[PATH_LEN], type[sizeof(telemetry.zone)];
+        snprintf(path, sizeof(path), "%s/class/thermal/thermal_zone%d/type",
+                 telemetry.root, i);
+        if (read_line(path, type, sizeof(type)))
+            break;
+
+        int is_cpu = 0;
+        for (size_t j = 0; j < ARRAY_SIZE(cpu_zones); j++)
+            is_cpu |= !!strstr(type, cpu_zones[j]);
+        if (telemetry.temp[0] && !is_cpu)
+            continue;
+
+        snprintf(telemetry.temp, sizeof(telemetry.temp),
+                 "%s/class/thermal/thermal_zone%d/temp", telemetry.root, i);
+        memcpy(telemetry.zone, type, sizeof(type));
+        if (is_cpu)
+            break;
+    }
+}
+
+COLD int checkasm_telemetry_init(const char *const root)
+{
+    telemetry.root = root;
+    open_cpu(current_cpu());
+    open_thermal();
+
+    CheckasmTelemetrySample sample;
+    checkasm_telemetry_read(&sample);
+
+    char clock[64] = "no clock", temp[64] = "no temperature";
+    if (sample.ratio) {
+        snprintf(clock, sizeof(clock), "clock vs %.0f MHz on CPU %d",
+                 telemetry.ref_khz / 1000.0, telemetry.cpu);
+    }
+    if (!isnan(sample.temp))
+        snprintf(temp, sizeof(temp), "temperature of %s", telemetry.zone);
+    snprintf(telemetry.desc, sizeof(telemetry.desc), "%s, %s", clock, temp);
+
+    return !sample.ratio && isnan(sample.temp);
+}
+
+const char *checkasm_telemetry_desc(void)
+{
+    return telemetry.desc;
+}
+
+void checkasm_telemetry_read(CheckasmTelemetrySample *const sample)
+{
+    /* The process may have migrated, unless pinned with --affinity */
+    const int cpu = current_cpu();
+    if (cpu != telemetry.cpu)
+        open_cpu(cpu);
+
+    double khz, mdeg;
+    sample->ratio = telemetry.ref_khz > 0.0 && !read_double(telemetry.cur_freq, &khz)
+                      ? khz / telemetry.ref_khz
+                      : 0.0;
+    sample->temp  = telemetry.temp[0] && !read_double(telemetry.temp, &mdeg)
+                      ? mdeg / 1000.0
+                      : NAN;
+}
+
+/* Parses a list of CPUs in the kernel's "0-3,8,10-11" format, returning the
+ * number of CPUs written to `out` (at most `max`), or -1 if malformed */
+static int parse_cpulist(const char *list, int *const out, const int max)
+{
+    int nb = 0;
+    while (*list) {
+        char      *end;
+        const long lo = strtol(list, &end, 10);
+        long       hi = lo;
+        if (end == list || lo < 0)
+            return -1;
+        if (*end == '-') {
+            list = end + 1;
+            hi   = strtol(list, &end, 10);
+            if (end == list || hi < lo)
+                return -1;
+        }
+        for (long cpu = lo; cpu <= hi && nb < max; cpu++)
+            out[nb++] = (int) cpu;
+        if (*end != ',')
+            break;
+        list = end + 1;
+    }
+    return nb;
+}
+
+/* Whether the cpulist in the given file contains `cpu`, or -1 if unknown */
+static int cpulist_has(const char *const path, const int cpu)
+{
+    char list[1024];
+    int  cpus[1024];
+    if (read_line(path, list, sizeof(list)))
+        return -1;
+
+    /* Empty or "(null)" if no CPUs are listed */
+    const int nb = parse_cpulist(list, cpus, ARRAY_SIZE(cpus));
+    for (int i = 0; i < nb; i++) {
+        if (cpus[i] == cpu)
+            return 1;
+    }
+    return 0;
+}
+
+#ifdef __linux__
+/* Busy and total time of the given CPUs so far, in jiffies */
+static int read_cpu_times(const CheckasmEnvironment *const env, uint64_t *const busy,
+                          uint64_t *const total)
+{
+    FILE *const f = fopen("/proc/stat", "r");
+    if (!f)
+        return 1;
+
+    char line[256];
+    *busy = *total = 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long long t[8] = { 0 };
+        int                cpu;
+        /* Skip the aggregate "cpu " line */
+        if (strncmp(line, "cpu", 3) || line[3] < '0' || line[3] > '9'
+            || sscanf(line + 3, "%d %llu %llu %llu %llu %llu %llu %llu %llu", &cpu,
+                      &t[0], &t[1], &t[2], &t[3], &t[4], &t[5], &t[6], &t[7])
+                   < 5)
+            continue;
+
+        for (int i = 0; i < env->nb_siblings; i++) {
+            if (env->siblings[i] != cpu)
+                continue;
+            uint64_t sum = 0;
+            for (size_t j = 0; j < ARRAY_SIZE(t); j++)
+                sum += t[j];
+            *total += sum;
+            *busy += sum - t[3] - t[4]; /* minus idle and iowait */
+        }
+    }
+
+    fclose(f);
+    return 0;
+}
+
+static double sibling_load(const CheckasmEnvironment *const env)
+{
+    uint64_t busy0, total0, busy1, total1;
+    if (!env->nb_siblings || read_cpu_times(env, &busy0, &total0))
+        return NAN;
+
+    const struct timespec delay = { 0, 100000000 }; /* 100 ms */
+    nanosleep(&delay, NULL);
+
+    if (read_cpu_times(env, &busy1, &total1) || total1 <= total0)
+        return NAN;
+    return (double) (busy1 - busy0) / (total1 - total0);
+}
+#endif
+
+COLD void checkasm_env_check(CheckasmEnvironment *const env, const char *const root,
+                             const int cpu)
+{
+    char path[PATH_LEN], buf[256];
+
+    *env = (CheckasmEnvironment) {
+        .cpu           = cpu >= 0 ? cpu : current_cpu(),
+        .turbo         = -1,
+        .sibling_load  = NAN,
+        .memlock_limit = -1,
+    };
+
+    snprintf(path, sizeof(path), "%s/devices/system/cpu/cpu%d/cpufreq/scaling_governor",
+             root, env->cpu);
+    read_line(path, env->governor, sizeof(env->governor));
+
+    /* intel_pstate has its own knob, inverted */
+    snprintf(path, sizeof(path), "%s/devices/system/cpu/intel_pstate/no_turbo", root);
+    if (!read_line(path, buf, sizeof(buf))) {
+        env->turbo = buf[0] == '0';
+    } else {
+        snprintf(path, sizeof(path), "%s/devices/system/cpu/cpufreq/boost", root);
+        if (!read_line(path, buf, sizeof(buf)))
+            env->turbo = buf[0] == '1';
+    }
+
+    snprintf(path, sizeof(path), "%s/devices/system/cpu/isolated", root);
+    env->isolated = cpulist_has(path, env->cpu);
+    snprintf(path, sizeof(path), "%s/devices/system/cpu/nohz_full", root);
+    env->nohz_full = cpulist_has(path, env->cpu);
+
+    snprintf(path, sizeof(path),
+             "%s/devices/system/cpu/cpu%d/topology/thread_siblings_list", root,
+             env->cpu);
+    int cpus[ARRAY_SIZE(env->siblings) + 1];
+    const int nb = read_line(path, buf, sizeof(buf))
+                     ? 0
+                     : parse_cpulist(buf, cpus, ARRAY_SIZE(cpus));
+    for (int i = 0; i < nb; i++) {
+        if (cpus[i] != env->cpu && env->nb_siblings < (int) ARRAY_SIZE(env->siblings))
+            env->siblings[env->nb_siblings++] = cpus[i];
+    }
+
+#ifdef __linux__
+    env->sibling_load = sibling_load(env);
+#endif
+}
+
+/* Touch the stack below the caller, so it is mapped before being locked */
+static NOINLINE void prefault_stack(void)
+{
+    volatile uint8_t buf[64 << 10];
+    for (size_t i = 0; i < sizeof(buf); i += 4096)
+        buf[i] = 0;
+}
+
+#if HAVE_MLOCKALL
+/* Bytes currently mapped, or 0 if unknown */
+static uint64_t mapped_bytes(void)
+{
+    char buf[64];
+    if (read_line("/proc/self/statm", buf, sizeof(buf)))
+        return 0;
+    return strtoull(buf, NULL, 10) * (uint64_t) sysconf(_SC_PAGESIZE);
+}
+
+/* Only lock what is mapped now: locking future allocations as well would make
+ * any large buffer allocated later fail against RLIMIT_MEMLOCK */
+static void lock_memory(CheckasmEnvironment *const env)
+{
+    struct rlimit lim;
+    if (!getrlimit(RLIMIT_MEMLOCK, &lim) && lim.rlim_cur != RLIM_INFINITY)
+        env->memlock_limit = (int64_t) lim.rlim_cur;
+
+    /* Don't bother if it can't fit, unless privileged (CAP_IPC_LOCK) */
+    const uint64_t size = mapped_bytes();
+    if (env->memlock_limit >= 0 && size > (uint64_t) env->memlock_limit && geteuid())
+        return;
+
+    env->locked = !mlockall(MCL_CURRENT);
+}
+#endif
+
+COLD void checkasm_env_harden(CheckasmEnvironment *const env)
+{
+    prefault_stack();
+#if HAVE_MLOCKALL
+    lock_memory(env);
+#endif
+
+#if HAVE_SETPRIORITY
+    errno     = 0;
+    env->nice = getpriority(PRIO_PROCESS, 0);
+    if (errno)
+        env->nice = 0;
+    /* Raise the priority as far as RLIMIT_NICE allows */
+    for (int nice = -20; nice < env->nice; nice++) {
+        if (!setpriority(PRIO_PROCESS, 0, nice)) {
+            env->nice = nice;
+            break;
+        }
+    }
+#endif
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2025, Niklas Haas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CHECKASM_TELEMETRY_H
+#define CHECKASM_TELEMETRY_H
+
+#include <stdint.h>
+
+/* Clock frequency and temperature of the CPU we are running on, read from the
+ * Linux cpufreq and thermal sysfs interfaces, see --telemetry */
+typedef struct CheckasmTelemetrySample {
+    double ratio; /* current / reference clock frequency, or 0 if unknown */
+    double temp;  /* in degrees Celsius, or NAN if unknown */
+} CheckasmTelemetrySample;
+
+/* Locates the sysfs files below `root` (normally "/sys"). Returns 0 if at least
+ * one of the frequency or temperature can be read, 1 otherwise */
+int checkasm_telemetry_init(const char *root);
+
+/* Describe the sources found by checkasm_telemetry_init(), for the log */
+const char *checkasm_telemetry_desc(void);
+
+void checkasm_telemetry_read(CheckasmTelemetrySample *sample);
+
+/* State of the benchmark environment, as checked and hardened by --stable-env */
+typedef struct CheckasmEnvironment {
+    int     cpu;           /* CPU the checks apply to */
+    char    governor[32];  /* cpufreq scaling governor, or "" if unknown */
+    int     turbo;         /* turbo boost enabled (1), disabled (0) or unknown (-1) */
+    int     isolated;      /* CPU is in isolcpus (1), not (0) or unknown (-1) */
+    int     nohz_full;     /* CPU is in nohz_full (1), not (0) or unknown (-1) */
+    int     siblings[8];   /* other SMT threads of the same core */
+    int     nb_siblings;
+    double  sibling_load;  /* busy fraction of the SMT siblings, or NAN if unknown */
+    int     locked;        /* memory mapped so far was locked and pre-faulted */
+    int64_t memlock_limit; /* RLIMIT_MEMLOCK in bytes, or -1 if unlimited/unknown */
+    int     nice;          /* scheduling priority after raising it */
+} CheckasmEnvironment;
+
+/* Inspects the frequency scaling, isolation and SMT siblings of `cpu` (or the
+ * current CPU, if negative) below the sysfs `root`. Takes about 100 ms, to
+ * sample the load of the SMT siblings */
+void checkasm_env_check(CheckasmEnvironment *env, const char *root, int cpu);
+
+/* Locks and pre-faults the memory mapped so far, if it fits in RLIMIT_MEMLOCK,
+ * and raises the scheduling priority of the process, as far as permitted */
+void checkasm_env_harden(CheckasmEnvironment *env);
+
+#endif /* CHECKASM_TELEMETRY_H */
@@ -0,0 +1,181 @@
+/*
+ * Copyright © 2025, Niklas Haas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "checkasm_config.h"
+
+#if HAVE_SCHED_GETCPU
+  /* _GNU_SOURCE is required for sched_getcpu on glibc. */
+  #ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+  #endif
+  #include <sched.h>
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "internal.h"
+#include "trace.h"
+
+static struct {
+    FILE       *file;
+    const char *path;
+} trace;
+
+int checkasm_trace_open(const char *const path, const char *const unit,
+                        const double nsec_per_unit)
+{
+    CheckasmTraceHeader hdr = {
+        .version       = CHECKASM_TRACE_VERSION,
+        .header_size   = sizeof(CheckasmTraceHeader),
+        .record_size   = sizeof(CheckasmTraceRecord),
+        .byte_order    = 0x01020304,
+        .nsec_per_unit = nsec_per_unit,
+    };
+    memcpy(hdr.magic, CHECKASM_TRACE_MAGIC, sizeof(hdr.magic));
+    snprintf(hdr.unit, sizeof(hdr.unit), "%s", unit);
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "checkasm: failed to open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    const int written = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+    if (fclose(f) || !written) {
+        fprintf(stderr, "checkasm: failed to write %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    /* Reopen in append mode, so that records from forked processes sharing
+     * the file are never written on top of each other */
+    if (!(f = fopen(path, "ab"))) {
+        fprintf(stderr, "checkasm: failed to open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    trace.file = f;
+    trace.path = path;
+    return 0;
+}
+
+void checkasm_trace_close(void)
+{
+    if (!trace.file)
+        return;
+
+    const int err = ferror(trace.file);
+    if (fclose(trace.file) || err)
+        fprintf(stderr, "checkasm: failed to write %s\n", trace.path);
+    trace.file = NULL;
+}
+
+void checkasm_trace_flush(void)
+{
+    if (trace.file)
+        fflush(trace.file);
+}
+
+static int trace_cpu(void)
+{
+#if HAVE_SCHED_GETCPU
+    const int cpu = sched_getcpu();
+    return cpu >= 0 && cpu < 0xffff ? cpu : 0xffff;
+#else
+    return 0xffff;
+#endif
+}
+
+/* 64-bit FNV-1a, including the terminator */
+static uint64_t hash_str(uint64_t hash, const char *str)
+{
+    do {
+        hash ^= (unsigned char) *str;
+        hash *= UINT64_C(0x100000001b3);
+    } while (*str++);
+    return hash;
+}
+
+uint64_t checkasm_trace_name(const char *const test, const char *const func,
+                             const char *const suffix)
+{
+    uint64_t id = UINT64_C(0xcbf29ce484222325);
+    id          = hash_str(hash_str(hash_str(id, test), func), suffix);
+
+    if (!trace.file)
+        return id;
+
+    const size_t len_test = strlen(test) + 1;
+    const size_t len_func = strlen(func) + 1;
+    const size_t len      = len_test + len_func + strlen(suffix) + 1;
+    const size_t padded   = (len + sizeof(CheckasmTraceRecord) - 1)
+                        & ~(sizeof(CheckasmTraceRecord) - 1);
+
+    const CheckasmTraceRecord rec = {
+        .id        = id,
+        .timestamp = checkasm_gettime_nsec(),
+        .count     = (uint32_t) len,
+        .type      = CHECKASM_TRACE_NAME,
+        .cpu       = 0xffff,
+    };
+
+    char *const buf   = checkasm_mallocz(sizeof(rec) + padded);
+    char *const names = buf + sizeof(rec);
+    memcpy(buf, &rec, sizeof(rec));
+    memcpy(names, test, len_test);
+    memcpy(names + len_test, func, len_func);
+    memcpy(names + len_test + len_func, suffix, len - len_test - len_func);
+
+    /* Start from an empty stdio buffer and flush it right away, so the record
+     * and its names reach the file in a single write(), which other processes
+     * appending to the same file (--jobs) can't interleave with */
+    fflush(trace.file);
+    fwrite(buf, sizeof(rec) + padded, 1, trace.file);
+    fflush(trace.file);
+    free(buf);
+    return id;
+}
+
+void checkasm_trace_sample(const uint64_t id, const int phase, const int count,
+                           const uint64_t cycles)
+{
+    if (!trace.file)
+        return;
+
+    const CheckasmTraceRecord rec = {
+        .id        = id,
+        .cycles    = cycles,
+        .timestamp = checkasm_gettime_nsec(),
+        .count     = (uint32_t) count,
+        .type      = CHECKASM_TRACE_SAMPLE,
+        .phase     = (uint8_t) phase,
+        .cpu       = (uint16_t) trace_cpu(),
+    };
+
+    fwrite(&rec, sizeof(rec), 1, trace.file);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2025, Niklas Haas
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CHECKASM_TRACE_H
+#define CHECKASM_TRACE_H
+
+#include <stdint.h>
+
+/* Binary trace of all benchmark samples, see --trace. The file starts with a
+ * CheckasmTraceHeader, followed by an append-only stream of fixed-size
+ * records, all in native byte order. Each function version is introduced by a
+ * name record before its first sample, so the file can be mapped as an array
+ * of records and processed without any parsing. */
+#define CHECKASM_TRACE_MAGIC   "CHKASMTR"
+#define CHECKASM_TRACE_VERSION 1
+
+typedef struct CheckasmTraceHeader {
+    char     magic[8];      /* CHECKASM_TRACE_MAGIC, not terminated */
+    uint32_t version;       /* CHECKASM_TRACE_VERSION */
+    uint32_t header_size;   /* sizeof(CheckasmTraceHeader) */
+    uint32_t record_size;   /* sizeof(CheckasmTraceRecord) */
+    uint32_t byte_order;    /* 0x01020304, in native byte order */
+    char     unit[16];      /* unit of the sample cycles, e.g. "cycle" */
+    double   nsec_per_unit; /* timer scale, as measured at startup */
+} CheckasmTraceHeader;
+
+typedef enum CheckasmTraceType {
+    /* One checkasm_bench_update() call */
+    CHECKASM_TRACE_SAMPLE,
+
+    /* Introduces a function version ID. Followed by `count` bytes, padded to a
+     * whole number of records, containing the NUL-terminated test, function
+     * and version names. May be repeated by multiple processes. */
+    CHECKASM_TRACE_NAME,
+} CheckasmTraceType;
+
+typedef struct CheckasmTraceRecord {
+    uint64_t id;        /* function version ID, a hash of its names */
+    uint64_t cycles;    /* sum of the timed calls, 0 for name records */
+    uint64_t timestamp; /* monotonic time in nanoseconds */
+    uint32_t count;     /* number of timed calls, or length of the names */
+    uint8_t  type;      /* CheckasmTraceType */
+    uint8_t  phase;     /* 0 = regular, 1 = threads, 2 = latency, 3 = tail, 4 = cold */
+    uint16_t cpu;       /* CPU the sample was taken on, or 0xffff if unknown */
+} CheckasmTraceRecord;
+
+/* Truncates the file and writes the header. Returns 0 on success, prints an
+ * error message otherwise */
+int  checkasm_trace_open(const char *path, const char *unit, double nsec_per_unit);
+void checkasm_trace_close(void);
+
+/* Write out buffered records; must be called before fork() */
+void checkasm_trace_flush(void);
+
+/* Writes a name record and returns the ID of this function version */
+uint64_t checkasm_trace_name(const char *test, const char *func, const char *suffix);
+void     checkasm_trace_sample(uint64_t id, int phase, int count, uint64_t cycles);
+
+#endif /* CHECKASM_TRACE_H */
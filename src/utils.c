@@ -151,7 +151,9 @@ static ALWAYS_INLINE void xoshiro128pp(CheckasmRand *restrict xs, uint32_t *rest
     }
 }
 
-static void prng(CheckasmRand *restrict xs, uint8_t *restrict buf, size_t size)
+/* Fills `buf` with random bytes, masking each generated 32-bit word */
+static ALWAYS_INLINE void prng_masked(CheckasmRand *restrict xs, uint8_t *restrict buf,
+                                      size_t size, const uint32_t mask)
 {
     uint32_t     tmp[CHECKASM_PRNG_NUM];
     const size_t block_size = sizeof(tmp);
@@ -159,6 +161,8 @@ static void prng(CheckasmRand *restrict xs, uint8_t *restrict buf, size_t size)
 
     while (size >= block_size) {
         xoshiro128pp(&xs_copy, tmp);
+        for (int i = 0; i < CHECKASM_PRNG_NUM; i++)
+            tmp[i] &= mask;
         memcpy(buf, tmp, block_size);
         buf += block_size;
         size -= block_size;
@@ -166,12 +170,19 @@ static void prng(CheckasmRand *restrict xs, uint8_t *restrict buf, size_t size)
 
     if (size) {
         xoshiro128pp(&xs_copy, tmp);
+        for (int i = 0; i < CHECKASM_PRNG_NUM; i++)
+            tmp[i] &= mask;
         memcpy(buf, tmp, size);
     }
 
     *xs = xs_copy;
 }
 
+static void prng(CheckasmRand *restrict xs, uint8_t *restrict buf, size_t size)
+{
+    prng_masked(xs, buf, size, UINT32_MAX);
+}
+
 /* Efficient wrapper for generating individual random integers, by caching
  * the result of a single call to the underlying generator() */
 static struct {
@@ -294,44 +305,75 @@ void checkasm_randomize(void *buf, size_t bytes)
 
 void checkasm_randomize_mask8(uint8_t *buf, int width, uint8_t mask)
 {
-    prng(&checkasm_prng, (uint8_t *) buf, width * sizeof(*buf));
-    for (int i = 0; i < width; i++)
-        buf[i] &= mask;
+    prng_masked(&checkasm_prng, buf, width * sizeof(*buf), mask * 0x01010101U);
 }
 
 void checkasm_randomize_mask16(uint16_t *buf, int width, uint16_t mask)
 {
-    prng(&checkasm_prng, (uint8_t *) buf, width * sizeof(*buf));
-    for (int i = 0; i < width; i++)
-        buf[i] &= mask;
+    prng_masked(&checkasm_prng, (uint8_t *) buf, width * sizeof(*buf),
+                mask * 0x00010001U);
 }
 
+/* Converted in chunks of this many bytes, while still in the L1 cache. Must be
+ * a multiple of the cache size, so that chunking doesn't affect the values */
+#define PRNG_CHUNK_SIZE 4096
+static_assert(PRNG_CHUNK_SIZE % PRNG_CACHE_SIZE == 0,
+              "PRNG_CHUNK_SIZE should be a multiple of PRNG_CACHE_SIZE");
+
+/* Fill `buf` with `expr` evaluated for successive values of `x`, which are
+ * exactly the values checkasm_rand_uint32() would have returned. That function
+ * consumes each block of cached values back to front, so the same is done here
+ * for whole blocks generated directly into a temporary buffer */
+#define RANDOMIZE_UINT32(buf, width, x, expr)                                            \
+    do {                                                                                 \
+        uint32_t  tmp[PRNG_CHUNK_SIZE / sizeof(uint32_t)];                               \
+        const int block = ARRAY_SIZE(prng_cache.buf32);                                  \
+        for (; width > 0 && prng_cache.num32; width--) {                                 \
+            const uint32_t x = checkasm_rand_uint32();                                   \
+            *(buf)++         = expr;                                                     \
+        }                                                                                \
+                                                                                         \
+        while (width >= block) {                                                         \
+            const int n = imin(width, ARRAY_SIZE(tmp)) & ~(block - 1);                   \
+            prng(&checkasm_prng, (uint8_t *) tmp, n * sizeof(uint32_t));                 \
+            for (int i = 0; i < n; i += block) {                                         \
+                for (int j = 0; j < block; j++) {                                        \
+                    const uint32_t x = tmp[i + block - 1 - j];                           \
+                    (buf)[i + j]     = expr;                                             \
+                }                                                                        \
+            }                                                                            \
+            buf += n;                                                                    \
+            width -= n;                                                                  \
+        }                                                                                \
+                                                                                         \
+        for (; width > 0; width--) {                                                     \
+            const uint32_t x = checkasm_rand_uint32();                                   \
+            *(buf)++         = expr;                                                     \
+        }                                                                                \
+    } while (0)
+
 void checkasm_randomize_range(double *buf, int width, double range)
 {
     const double scale = range / (UINT32_MAX + 1.0);
-    while (width--)
-        *buf++ = scale * checkasm_rand_uint32();
+    RANDOMIZE_UINT32(buf, width, x, scale * x);
 }
 
 void checkasm_randomize_rangef(float *buf, int width, float range)
 {
     const float scale = (float) (range / (UINT32_MAX + 1.0));
-    while (width--)
-        *buf++ = scale * checkasm_rand_uint32();
+    RANDOMIZE_UINT32(buf, width, x, scale * x);
 }
 
 void checkasm_randomize_interval(double *buf, int width, double low, double high)
 {
     const double scale = (high - low) / (double) UINT32_MAX;
-    while (width--)
-        *buf++ = scale * checkasm_rand_uint32() + low;
+    RANDOMIZE_UINT32(buf, width, x, scale * x + low);
 }
 
 void checkasm_randomize_intervalf(float *buf, int width, float low, float high)
 {
     const float scale = (high - low) / (float) UINT32_MAX;
-    while (width--)
-        *buf++ = scale * checkasm_rand_uint32() + low;
+    RANDOMIZE_UINT32(buf, width, x, scale * x + low);
 }
 
 #define RANDOMIZE_DIST(buf, ftype, width, mean, stddev)                                  \
@@ -433,12 +475,29 @@ void checkasm_init(void *buf, size_t bytes)
     checkasm_init_mask8(buf, (int) bytes, 0xFF);
 }
 
+/* Set from CheckasmConfig.exact_init */
+int checkasm_exact_init;
+
+/* Run `body` for every `j` in [0, n), in fixed size blocks so that the compiler
+ * can vectorize it */
+#define INIT_LOOP(n, j, body)                                                            \
+    do {                                                                                 \
+        int j##_block = 0;                                                               \
+        for (; j##_block + 16 <= (n); j##_block += 16) {                                 \
+            for (int j##_off = 0; j##_off < 16; j##_off++) {                             \
+                const int j = j##_block + j##_off;                                       \
+                body;                                                                    \
+            }                                                                            \
+        }                                                                                \
+        for (int j = j##_block; j < (n); j++)                                            \
+            body;                                                                        \
+    } while (0)
+
 #define DEF_CHECKASM_INIT_MASK(BITS, PIXEL)                                              \
-    void checkasm_init_mask##BITS(PIXEL *buf, const int width, const PIXEL mask_pixel)   \
+    /* Per-element generator used by earlier versions, see checkasm_exact_init */        \
+    static void init_mask_exact##BITS(PIXEL *buf, const int width,                       \
+                                      const PIXEL mask_pixel)                            \
     {                                                                                    \
-        if (!width)                                                                      \
-            return;                                                                      \
-                                                                                         \
         int step = 0, mode = 0, mask = mask_pixel;                                       \
         for (int i = 0; i < width; i++, step--) {                                        \
             if (!step) {                                                                 \
@@ -460,6 +519,65 @@ void checkasm_init(void *buf, size_t bytes)
             case PAT_MIX:   buf[i] = (checkasm_rand_uint8() & 1) ? low : high; break;    \
             }                                                                            \
         }                                                                                \
+    }                                                                                    \
+                                                                                         \
+    /* Fill a single run of `n` elements starting at `buf`, with the same                \
+     * pattern. `odd` is the parity of the first element within the buffer */            \
+    static void init_run##BITS(PIXEL *buf, const int n, const int mode, const int odd,   \
+                               const PIXEL mask, const PIXEL mask_pixel)                 \
+    {                                                                                    \
+        PIXEL tmp[PRNG_CHUNK_SIZE / sizeof(PIXEL)];                                      \
+        switch (mode) {                                                                  \
+        case PAT_ZERO:                                                                   \
+            memset(buf, 0, n * sizeof(PIXEL));                                           \
+            return;                                                                      \
+        case PAT_ONE:                                                                    \
+            INIT_LOOP(n, j, buf[j] = mask_pixel);                                        \
+            return;                                                                      \
+        case PAT_RAND:                                                                   \
+            checkasm_randomize_mask##BITS(buf, n, mask_pixel);                           \
+            return;                                                                      \
+        }                                                                                \
+                                                                                         \
+        checkasm_randomize_mask##BITS(buf, n, mask);                                     \
+        switch (mode) {                                                                  \
+        case PAT_HIGH:                                                                   \
+            INIT_LOOP(n, j, buf[j] = mask_pixel - buf[j]);                               \
+            break;                                                                       \
+        case PAT_ALTLO:                                                                  \
+        case PAT_ALTHI: {                                                                \
+            const int high = odd ^ (mode == PAT_ALTHI); /* parity of high elements */    \
+            INIT_LOOP(n, j, buf[j] = ((j ^ high) & 1) ? mask_pixel - buf[j] : buf[j]);   \
+            break;                                                                       \
+        }                                                                                \
+        case PAT_MIX:                                                                    \
+            for (int i = 0; i < n; i += ARRAY_SIZE(tmp)) {                               \
+                const int len = imin(n - i, ARRAY_SIZE(tmp));                            \
+                PIXEL    *dst = &buf[i];                                                 \
+                checkasm_randomize_mask##BITS(tmp, len, 1);                              \
+                INIT_LOOP(len, j, dst[j] = tmp[j] ? dst[j] : mask_pixel - dst[j]);       \
+            }                                                                            \
+            break;                                                                       \
+        }                                                                                \
+    }                                                                                    \
+                                                                                         \
+    void checkasm_init_mask##BITS(PIXEL *buf, const int width, const PIXEL mask_pixel)   \
+    {                                                                                    \
+        if (!width)                                                                      \
+            return;                                                                      \
+        if (checkasm_exact_init) {                                                       \
+            init_mask_exact##BITS(buf, width, mask_pixel);                               \
+            return;                                                                      \
+        }                                                                                \
+                                                                                         \
+        /* Decide the pattern once per run, then fill all of it at once */               \
+        for (int i = 0; i < width;) {                                                    \
+            const int   n    = imin(imax(shift_rand(width), 1), width - i);              \
+            const int   mode = checkasm_rand_uint8() & 7;                                \
+            const PIXEL mask = shift_rand(mask_pixel);                                   \
+            init_run##BITS(&buf[i], n, mode, i & 1, mask, mask_pixel);                   \
+            i += n;                                                                      \
+        }                                                                                \
     }
 
 DEF_CHECKASM_INIT_MASK(8, uint8_t)
@@ -567,12 +685,23 @@ static int get_terminal_width(void)
     return 80;
 }
 
-void checkasm_json(CheckasmJson *json, const char *key, const char *const fmt, ...)
+static void json_newline(CheckasmJson *json)
 {
-    assert(json->level > 0);
+    if (json->compact) {
+        if (json->nonempty)
+            fputs(", ", json->file);
+        return;
+    }
+
     fputs(json->nonempty ? ",\n" : "\n", json->file);
     for (int i = 0; i < json->level; i++)
         fputc(' ', json->file);
+}
+
+void checkasm_json(CheckasmJson *json, const char *key, const char *const fmt, ...)
+{
+    assert(json->level > 0);
+    json_newline(json);
 
     va_list ap;
     va_start(ap, fmt);
@@ -586,9 +715,7 @@ void checkasm_json(CheckasmJson *json, const char *key, const char *const fmt, .
 void checkasm_json_str(CheckasmJson *json, const char *key, const char *str)
 {
     assert(json->level > 0);
-    fputs(json->nonempty ? ",\n" : "\n", json->file);
-    for (int i = 0; i < json->level; i++)
-        fputc(' ', json->file);
+    json_newline(json);
 
     if (key)
         fprintf(json->file, "\"%s\": \"", key);
@@ -610,9 +737,7 @@ void checkasm_json_str(CheckasmJson *json, const char *key, const char *str)
 
 void checkasm_json_push(CheckasmJson *json, const char *const key, const char type)
 {
-    fputs(json->nonempty ? ",\n" : "\n", json->file);
-    for (int i = 0; i < json->level; i++)
-        fputc(' ', json->file);
+    json_newline(json);
 
     if (key) {
         fprintf(json->file, "\"%s\": %c", key, type);
@@ -628,7 +753,7 @@ void checkasm_json_pop(CheckasmJson *json, char type)
 {
     assert(json->level >= 2);
     json->level -= 2;
-    if (json->nonempty) {
+    if (json->nonempty && !json->compact) {
         fputc('\n', json->file);
         for (int i = 0; i < json->level; i++)
             fputc(' ', json->file);
@@ -666,14 +791,56 @@ int checkasm_float_near_ulp(const float a, const float b, const unsigned max_ulp
     return 0;
 }
 
+/* Branch-free versions of the above, returning nonzero on mismatch */
+static inline int ulp_mismatch(const float a, const float b, const int32_t max_ulp)
+{
+    intfloat x, y;
+
+    x.f = a;
+    y.f = b;
+
+    /* Same sign here, so the difference always fits */
+    const int32_t diff = (int32_t) (x.i - y.i);
+    if ((x.i ^ y.i) >> 31)
+        return ((x.i | y.i) << 1) != 0; /* -0.0 == +0.0 */
+    return diff > max_ulp || diff < -max_ulp;
+}
+
+static inline int eps_mismatch(const float a, const float b, const float eps)
+{
+    return !(fabsf(a - b) < eps);
+}
+
+static inline int deps_mismatch(const double a, const double b, const double eps)
+{
+    return !(fabs(a - b) < eps);
+}
+
+/* Compare arrays in fixed size blocks, without branching inside a block, so
+ * that the inner loop is vectorized by the compiler */
+#define NEAR_BLOCK 16
+#define NEAR_ARRAY(mismatch, a, b, len, ...)                                             \
+    do {                                                                                 \
+        ptrdiff_t i = 0;                                                                 \
+        for (; i + NEAR_BLOCK <= (ptrdiff_t) (len); i += NEAR_BLOCK) {                   \
+            int bad = 0;                                                                 \
+            for (int j = 0; j < NEAR_BLOCK; j++)                                         \
+                bad = mismatch(a[i + j], b[i + j], __VA_ARGS__) ? 1 : bad;               \
+            if (bad)                                                                     \
+                return 0;                                                                \
+        }                                                                                \
+        for (; i < (ptrdiff_t) (len); i++) {                                             \
+            if (mismatch(a[i], b[i], __VA_ARGS__))                                       \
+                return 0;                                                                \
+        }                                                                                \
+        return 1;                                                                        \
+    } while (0)
+
 int checkasm_float_near_ulp_array(const float *const a, const float *const b,
                                   const unsigned max_ulp, const int len)
 {
-    for (int i = 0; i < len; i++)
-        if (!float_near_ulp(a[i], b[i], max_ulp))
-            return 0;
-
-    return 1;
+    const int32_t max_diff = max_ulp > INT32_MAX ? INT32_MAX : (int32_t) max_ulp;
+    NEAR_ARRAY(ulp_mismatch, a, b, len, max_diff);
 }
 
 int checkasm_float_near_abs_eps(const float a, const float b, const float eps)
@@ -684,11 +851,7 @@ int checkasm_float_near_abs_eps(const float a, const float b, const float eps)
 int checkasm_float_near_abs_eps_array(const float *const a, const float *const b,
                                       const float eps, const int len)
 {
-    for (int i = 0; i < len; i++)
-        if (!float_near_abs_eps(a[i], b[i], eps))
-            return 0;
-
-    return 1;
+    NEAR_ARRAY(eps_mismatch, a, b, len, eps);
 }
 
 int checkasm_float_near_abs_eps_ulp(const float a, const float b, const float eps,
@@ -697,15 +860,18 @@ int checkasm_float_near_abs_eps_ulp(const float a, const float b, const float ep
     return float_near_ulp(a, b, max_ulp) || float_near_abs_eps(a, b, eps);
 }
 
+static inline int eps_ulp_mismatch(const float a, const float b, const float eps,
+                                   const int32_t max_ulp)
+{
+    return ulp_mismatch(a, b, max_ulp) & eps_mismatch(a, b, eps);
+}
+
 int checkasm_float_near_abs_eps_array_ulp(const float *const a, const float *const b,
                                           const float eps, const unsigned max_ulp,
                                           const int len)
 {
-    for (int i = 0; i < len; i++)
-        if (!float_near_abs_eps_ulp(a[i], b[i], eps, max_ulp))
-            return 0;
-
-    return 1;
+    const int32_t max_diff = max_ulp > INT32_MAX ? INT32_MAX : (int32_t) max_ulp;
+    NEAR_ARRAY(eps_ulp_mismatch, a, b, len, eps, max_diff);
 }
 
 int checkasm_double_near_abs_eps(const double a, const double b, const double eps)
@@ -716,11 +882,7 @@ int checkasm_double_near_abs_eps(const double a, const double b, const double ep
 int checkasm_double_near_abs_eps_array(const double *const a, const double *const b,
                                        const double eps, const unsigned len)
 {
-    for (unsigned i = 0; i < len; i++)
-        if (!double_near_abs_eps(a[i], b[i], eps))
-            return 0;
-
-    return 1;
+    NEAR_ARRAY(deps_mismatch, a, b, len, eps);
 }
 
 static int check_err(const char *const file, const int line, const char *const name,
@@ -796,6 +958,23 @@ static int check_err(const char *const file, const int line, const char *const n
         }                                                                                \
     } while (0)
 
+/* Compare a rectangle without reporting anything, in a single call if its rows
+ * are contiguous in both buffers */
+#define SAME_RECT(ystart, yend, xstart, xend, compare)                                   \
+    do {                                                                                 \
+        const int xw = xend - xstart;                                                    \
+        if (!same || ystart >= yend || xw <= 0)                                          \
+            break;                                                                       \
+        if (stride1 == stride2 && xw == stride1) {                                       \
+            same = compare(&buf1[ystart * stride1 + xstart],                             \
+                           &buf2[ystart * stride2 + xstart], (yend - ystart) * xw);      \
+            break;                                                                       \
+        }                                                                                \
+        for (int y = ystart; same && y < yend; y++)                                      \
+            same = compare(&buf1[y * stride1 + xstart], &buf2[y * stride2 + xstart],     \
+                           xw);                                                          \
+    } while (0)
+
 #define DEF_CHECKASM_CHECK_BODY(compare, type, fmt, fmtw)                                \
     do {                                                                                 \
         const int overhead   = 5 + 3 + 3;                                                \
@@ -804,10 +983,26 @@ static int check_err(const char *const file, const int line, const char *const n
         stride1 /= sizeof(type);                                                         \
         stride2 /= sizeof(type);                                                         \
                                                                                          \
+        /* Quickly rule out any differences first, comparing each row along with         \
+         * its padding in a single pass where possible */                                \
+        const int aligned_h = (h + align_h - 1) & ~(align_h - 1);                        \
+        int       same      = 1;                                                         \
+        if (aligned_w == w || !padding) {                                                \
+            SAME_RECT(0, h, -padding, w + padding, compare);                             \
+        } else {                                                                         \
+            SAME_RECT(0, h, -padding, w, compare);                                       \
+            SAME_RECT(0, h, aligned_w, aligned_w + padding, compare);                    \
+        }                                                                                \
+        if (align_h >= 1) {                                                              \
+            SAME_RECT(-padding, 0, -padding, w + padding, compare);                      \
+            SAME_RECT(aligned_h, aligned_h + padding, -padding, w + padding, compare);   \
+        }                                                                                \
+        if (same)                                                                        \
+            return 0;                                                                    \
+                                                                                         \
         int err = 0;                                                                     \
         CHECK_RECT(buf1, buf2, 0, h, 0, w, "", compare, type, fmt, fmtw);                \
         if (align_h >= 1) {                                                              \
-            const int aligned_h = (h + align_h - 1) & ~(align_h - 1);                    \
             CHECK_RECT(buf1, buf2, -padding, 0, -padding, w + padding, "overwrite top",  \
                        compare, type, fmt, fmtw);                                        \
             CHECK_RECT(buf1, buf2, aligned_h, aligned_h + padding, -padding,             \
@@ -863,3 +1058,121 @@ char *checkasm_vasprintf(const char *fmt, va_list arg)
     vsnprintf(buf, len + 1, fmt, arg);
     return buf;
 }
+
+#define ARENA_BLOCK_SIZE (256 << 10)
+
+/* Strictest alignment required by any of the stored objects */
+typedef union ArenaAlign {
+    uint64_t u;
+    double   d;
+    void    *p;
+} ArenaAlign;
+
+typedef struct CheckasmArenaBlock {
+    struct CheckasmArenaBlock *prev;
+    size_t                     size, used;
+    int                        dirty; /* recycled, needs clearing before use */
+    ArenaAlign                 data[];
+} CheckasmArenaBlock;
+
+/* Released blocks of the default size, kept around so that repeated runs
+ * don't have to fault in the same pages over and over again */
+static CheckasmArenaBlock *arena_cache;
+
+static CheckasmArenaBlock *arena_block(const size_t size)
+{
+    if (size == ARENA_BLOCK_SIZE && arena_cache) {
+        CheckasmArenaBlock *const block = arena_cache;
+        arena_cache                     = block->prev;
+        block->prev                     = NULL;
+        block->used                     = 0;
+        return block;
+    }
+
+    CheckasmArenaBlock *const block = checkasm_mallocz(sizeof(*block) + size);
+    block->size                     = size;
+    return block;
+}
+
+void *checkasm_arena_alloc(CheckasmArena *const arena, size_t size)
+{
+    size = (size + sizeof(ArenaAlign) - 1) & ~(sizeof(ArenaAlign) - 1);
+
+    CheckasmArenaBlock *block = arena->block;
+    if (size > ARENA_BLOCK_SIZE / 4) {
+        /* Give large allocations a dedicated block, behind the current one */
+        CheckasmArenaBlock *const large = arena_block(size);
+        large->used                     = size;
+        if (large->dirty) /* a recycled block, if size == ARENA_BLOCK_SIZE */
+            memset(large->data, 0, size);
+        if (block) {
+            large->prev = block->prev;
+            block->prev = large;
+        } else {
+            arena->block = large;
+        }
+        return large->data;
+    }
+
+    if (!block || block->size - block->used < size) {
+        block        = arena_block(ARENA_BLOCK_SIZE);
+        block->prev  = arena->block;
+        arena->block = block;
+    }
+
+    void *const ptr = (char *) block->data + block->used;
+    block->used += size;
+    if (block->dirty)
+        memset(ptr, 0, size);
+    return ptr;
+}
+
+char *checkasm_arena_strdup(CheckasmArena *const arena, const char *const str)
+{
+    const size_t len = strlen(str) + 1;
+    return memcpy(checkasm_arena_alloc(arena, len), str, len);
+}
+
+void checkasm_arena_merge(CheckasmArena *const dst, CheckasmArena *const src)
+{
+    CheckasmArenaBlock *tail = src->block;
+    if (!tail)
+        return;
+
+    while (tail->prev)
+        tail = tail->prev;
+    if (dst->block) {
+        /* Keep allocating from the current block of `dst` */
+        tail->prev       = dst->block->prev;
+        dst->block->prev = src->block;
+    } else {
+        dst->block = src->block;
+    }
+    src->block = NULL;
+}
+
+void checkasm_arena_uninit(CheckasmArena *const arena)
+{
+    CheckasmArenaBlock *block = arena->block;
+    while (block) {
+        CheckasmArenaBlock *const prev = block->prev;
+        if (block->size == ARENA_BLOCK_SIZE) {
+            block->dirty = 1;
+            block->prev  = arena_cache;
+            arena_cache  = block;
+        } else {
+            free(block);
+        }
+        block = prev;
+    }
+    arena->block = NULL;
+}
+
+void checkasm_arena_release(void)
+{
+    while (arena_cache) {
+        CheckasmArenaBlock *const prev = arena_cache->prev;
+        free(arena_cache);
+        arena_cache = prev;
+    }
+}
@@ -173,6 +173,32 @@ static COLD checkasm_simd_warmup_func get_simd_warmup(void)
     return simd_warmup;
 }
 
+COLD CheckasmX86Simd checkasm_get_x86_simd(void)
+{
+    CpuidRegisters r;
+    checkasm_cpu_cpuid(&r, 0, 0);
+    const uint32_t max_leaf = r.eax;
+    if (max_leaf < 7)
+        return CHECKASM_X86_SIMD_BASELINE;
+
+    checkasm_cpu_cpuid(&r, 1, 0);
+    const uint32_t ecx = r.ecx;
+    if (~ecx & 0x18001000) /* OSXSAVE/AVX/FMA */
+        return CHECKASM_X86_SIMD_BASELINE;
+
+    const uint64_t xcr0 = checkasm_cpu_xgetbv(0);
+    if (~xcr0 & 0x6) /* XMM/YMM */
+        return CHECKASM_X86_SIMD_BASELINE;
+
+    checkasm_cpu_cpuid(&r, 7, 0);
+    if (~r.ebx & 0x00000020) /* AVX2 */
+        return CHECKASM_X86_SIMD_BASELINE;
+    if (~xcr0 & 0xe0 || ~r.ebx & 0x00010000) /* ZMM/OPMASK, AVX512F */
+        return CHECKASM_X86_SIMD_AVX2;
+
+    return CHECKASM_X86_SIMD_AVX512;
+}
+
 void checkasm_simd_warmup(void)
 {
     static checkasm_simd_warmup_func simd_warmup = NULL;
@@ -72,6 +72,7 @@ void selftest_test_copy(copy_func fun, const char *name, const int min_width)
             checkasm_check_rect_padded_align(c_dst, c_dst_stride, a_dst, a_dst_stride, w, 1,
                                              "rect_align", 1, 1);
 
+            checkasm_bench_set_work(2 * w, w);
             checkasm_bench_new(a_dst, src, w);
         }
     }
@@ -80,6 +81,32 @@ void selftest_test_copy(copy_func fun, const char *name, const int min_width)
 #undef WIDTH
 }
 
+/* Reads the source from a buffer that ends right at a guard page */
+static void selftest_test_copy_guarded(copy_func fun, const char *name)
+{
+#define WIDTH 256
+    uint8_t *src   = checkasm_alloc_guarded(WIDTH, 1, CHECKASM_GUARD_END);
+    uint8_t *c_dst = checkasm_alloc_guarded(WIDTH, 1, CHECKASM_GUARD_END);
+    uint8_t *a_dst = checkasm_alloc_guarded(WIDTH, 1, CHECKASM_GUARD_END);
+    checkasm_init(src, WIDTH);
+
+    checkasm_declare(void, uint8_t *dest, const uint8_t *src, size_t n);
+
+    for (int w = 1; w <= WIDTH; w *= 2) {
+        if (checkasm_check_func(fun, "%s_%d", name, w)) {
+            checkasm_call_ref(c_dst + WIDTH - w, src + WIDTH - w, w);
+            checkasm_call_new(a_dst + WIDTH - w, src + WIDTH - w, w);
+            checkasm_check1d(uint8_t, c_dst + WIDTH - w, a_dst + WIDTH - w, w, "dst");
+        }
+    }
+
+    checkasm_free_guarded(src);
+    checkasm_free_guarded(c_dst);
+    checkasm_free_guarded(a_dst);
+    checkasm_report("%s", name);
+#undef WIDTH
+}
+
 void selftest_test_noop(noop_func fun, const char *name)
 {
     checkasm_declare(void, int);
@@ -147,6 +174,12 @@ static DEF_COPY_FUNC(underwrite)
     memcpy(dst, src, size - 4);
 }
 
+static DEF_COPY_FUNC(overread)
+{
+    memcpy(dst, src, size);
+    dst[0] ^= ((volatile const uint8_t *) src)[size] & 0;
+}
+
 static DEF_NOOP_FUNC(segfault)
 {
     volatile int *bad = NULL;
@@ -234,6 +267,7 @@ static void selftest_test_double_arg(void)
 DEF_COPY_GETTER(SELFTEST_CPU_FLAG_BAD_C, overwrite_left)
 DEF_COPY_GETTER(SELFTEST_CPU_FLAG_BAD_C, overwrite_right)
 DEF_COPY_GETTER(SELFTEST_CPU_FLAG_BAD_C, underwrite)
+DEF_COPY_GETTER(SELFTEST_CPU_FLAG_BAD_C, overread)
 DEF_NOOP_GETTER(SELFTEST_CPU_FLAG_BAD_C, segfault)
 
 /* Ensure we can call declare_func() inside check_func() */
@@ -290,7 +324,7 @@ static void selftest_test_variants(void)
             int y = checkasm_call_new(12345);
             if (x != y)
                 checkasm_fail();
-            checkasm_bench_new(12345);
+            checkasm_bench_chain_new(checkasm_chain(12345));
         }
     }
 
@@ -300,6 +334,7 @@ static void selftest_test_variants(void)
 void selftest_check_generic(void)
 {
     selftest_test_copy(selftest_copy_c, "copy_generic", 1);
+    selftest_test_copy_guarded(selftest_copy_c, "copy_guarded");
     selftest_test_float(selftest_sqrt, "sqrt_generic", 2.0f);
     selftest_test_float_arg();
     selftest_test_double(sqrt, "sqrt", 2.);
@@ -314,6 +349,7 @@ void selftest_check_generic(void)
     selftest_test_copy(get_overwrite_left(), "overwrite_left", 1);
     selftest_test_copy(get_overwrite_right(), "overwrite_right", 1);
     selftest_test_copy(get_underwrite(), "underwrite", 1);
+    selftest_test_copy_guarded(get_overread(), "overread");
     selftest_test_noop(get_segfault(), "segfault");
     selftest_test_check_declare();
 }
@@ -24,6 +24,8 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <inttypes.h>
+
 #include "tests.h"
 
 #include "src/internal.h"
@@ -97,11 +99,15 @@ static void selftest_test_randomize(void)
 
     if (checkasm_check_func(checkasm_randomize_range, "randomize_range")) {
         checkasm_declare(void, double *buf, int width, double range);
+        checkasm_bench_set_work(sizeof(buf.f64), ARRAY_SIZE(buf.f64));
+        checkasm_bench_set_ops(2 * ARRAY_SIZE(buf.f64)); /* scale and offset */
         checkasm_bench_new(buf.f64, ARRAY_SIZE(buf.f64), 100.0);
     }
 
     if (checkasm_check_func(checkasm_randomize_rangef, "randomize_rangef")) {
         checkasm_declare(void, float *buf, int width, float range);
+        checkasm_bench_set_work(sizeof(buf.f32), ARRAY_SIZE(buf.f32));
+        checkasm_bench_set_ops(2 * ARRAY_SIZE(buf.f32)); /* scale and offset */
         checkasm_bench_new(buf.f32, ARRAY_SIZE(buf.f32), 100.0f);
     }
 
@@ -162,26 +168,168 @@ static void selftest_test_init(void)
 {
     if (checkasm_check_func(checkasm_init, "init")) {
         checkasm_declare(void, void *buf, size_t bytes);
+        checkasm_bench_set_work(sizeof(buf.u8), ARRAY_SIZE(buf.u8));
         checkasm_bench_new(buf.u8, sizeof(buf.u8));
     }
 
     if (checkasm_check_func(checkasm_init_mask8, "init_mask8")) {
         checkasm_declare(void, uint8_t *buf, int width, uint8_t mask);
+        checkasm_bench_set_work(sizeof(buf.u8), ARRAY_SIZE(buf.u8));
         checkasm_bench_new(buf.u8, ARRAY_SIZE(buf.u8), 0x7F);
     }
 
     if (checkasm_check_func(checkasm_init_mask16, "init_mask16")) {
         checkasm_declare(void, uint16_t *buf, int width, uint16_t mask);
+        checkasm_bench_set_work(sizeof(buf.u16), ARRAY_SIZE(buf.u16));
         checkasm_bench_new(buf.u16, ARRAY_SIZE(buf.u16), 0x7FFF);
     }
 
     checkasm_report("init");
 }
 
+/* Compare large, padded frames with identical contents, which is the common
+ * case after a successful test */
+#define CMP_W      512
+#define CMP_H      256
+#define CMP_PAD    8
+#define CMP_STRIDE (CMP_W + 2 * CMP_PAD)
+#define CMP_SIZE   ((CMP_H + 2 * CMP_PAD) * CMP_STRIDE)
+#define CMP_OFFSET (CMP_PAD * CMP_STRIDE + CMP_PAD)
+
+static CHECKASM_ALIGN(uint8_t cmp_u8[2][CMP_SIZE]);
+static CHECKASM_ALIGN(float   cmp_f32[2][CMP_SIZE]);
+
+static void selftest_test_compare(void)
+{
+    checkasm_randomize(cmp_u8[0], sizeof(cmp_u8[0]));
+    checkasm_randomize_rangef(cmp_f32[0], CMP_SIZE, 1.0f);
+    memcpy(cmp_u8[1], cmp_u8[0], sizeof(cmp_u8[0]));
+    memcpy(cmp_f32[1], cmp_f32[0], sizeof(cmp_f32[0]));
+
+    const uint8_t  *u8_a       = cmp_u8[0] + CMP_OFFSET;
+    const uint8_t  *u8_b       = cmp_u8[1] + CMP_OFFSET;
+    const float    *f32_a      = cmp_f32[0] + CMP_OFFSET;
+    const float    *f32_b      = cmp_f32[1] + CMP_OFFSET;
+    const ptrdiff_t u8_stride  = sizeof(uint8_t) * CMP_STRIDE;
+    const ptrdiff_t f32_stride = sizeof(float) * CMP_STRIDE;
+
+    if (checkasm_check_func(checkasm_check_impl_uint8_t, "check_uint8_t")) {
+        checkasm_declare(int, const char *file, int line, const uint8_t *buf1,
+                         ptrdiff_t stride1, const uint8_t *buf2, ptrdiff_t stride2, int w,
+                         int h, const char *name, int align_w, int align_h, int padding);
+        checkasm_bench_set_work(2 * sizeof(uint8_t) * CMP_W * CMP_H, CMP_W * CMP_H);
+        checkasm_bench_new(__FILE__, __LINE__, u8_a, u8_stride, u8_b, u8_stride, CMP_W,
+                           CMP_H, "buf", 1, 1, CMP_PAD);
+    }
+
+    if (checkasm_check_func(checkasm_check_impl_float_ulp, "check_float_ulp")) {
+        checkasm_declare(int, const char *file, int line, const float *buf1,
+                         ptrdiff_t stride1, const float *buf2, ptrdiff_t stride2, int w,
+                         int h, const char *name, unsigned max_ulp, int align_w,
+                         int align_h, int padding);
+        checkasm_bench_set_work(2 * sizeof(float) * CMP_W * CMP_H, CMP_W * CMP_H);
+        checkasm_bench_new(__FILE__, __LINE__, f32_a, f32_stride, f32_b, f32_stride,
+                           CMP_W, CMP_H, "buf", 1, 1, 1, CMP_PAD);
+    }
+
+    if (checkasm_check_func(checkasm_float_near_ulp_array, "float_near_ulp_array")) {
+        checkasm_declare(int, const float *a, const float *b, unsigned max_ulp, int len);
+        checkasm_bench_set_work(2 * sizeof(float) * CMP_SIZE, CMP_SIZE);
+        checkasm_bench_new(cmp_f32[0], cmp_f32[1], 1, CMP_SIZE);
+    }
+
+    if (checkasm_check_func(checkasm_float_near_abs_eps_array,
+                            "float_near_abs_eps_array")) {
+        checkasm_declare(int, const float *a, const float *b, float eps, int len);
+        checkasm_bench_set_work(2 * sizeof(float) * CMP_SIZE, CMP_SIZE);
+        checkasm_bench_new(cmp_f32[0], cmp_f32[1], 1e-6f, CMP_SIZE);
+    }
+
+    checkasm_report("compare");
+}
+
+static void selftest_test_histogram(void)
+{
+    if (checkasm_check_func(checkasm_histogram_add, "histogram")) {
+        static CheckasmHistogram hist;
+        memset(&hist, 0, sizeof(hist));
+
+        /* Buckets must be contiguous, and both ends of each bucket must be
+         * counted in that bucket */
+        for (int i = 0; i < CHECKASM_HIST_BUCKETS; i++) {
+            const uint64_t start = checkasm_histogram_bucket_start(i);
+            const uint64_t width = checkasm_histogram_bucket_width(i);
+            const uint64_t end   = start + (width - 1);
+            const uint64_t next  = i + 1 < CHECKASM_HIST_BUCKETS
+                                     ? checkasm_histogram_bucket_start(i + 1)
+                                     : end + 1;
+            if (next != end + 1) {
+                if (checkasm_fail())
+                    fprintf(stderr, "bucket %d ends at %" PRIu64 ", next at %" PRIu64
+                            "\n", i, end, next);
+            }
+
+            checkasm_histogram_add(&hist, start);
+            checkasm_histogram_add(&hist, end);
+            if (hist.buckets[i] != 2) {
+                if (checkasm_fail())
+                    fprintf(stderr, "bucket %d holds %u of [%" PRIu64 ", %" PRIu64 "]\n",
+                            i, hist.buckets[i], start, end);
+            }
+        }
+
+        /* Quantiles of 1..1000 are within half a bucket, i.e. 1/32, of the
+         * exact value, and the maximum is kept exactly */
+        static const double quantiles[] = { 0.5, 0.9, 0.99, 1.0 };
+        memset(&hist, 0, sizeof(hist));
+        for (int i = 1; i <= 1000; i++)
+            checkasm_histogram_add(&hist, i);
+        for (int i = 0; i < (int) ARRAY_SIZE(quantiles); i++) {
+            const double exact = 1000.0 * quantiles[i];
+            const double value = checkasm_histogram_quantile(&hist, quantiles[i]);
+            if (fabs(value - exact) > exact / 32.0 || value > 1000.0) {
+                if (checkasm_fail())
+                    fprintf(stderr, "p%g: expected %g, got %g\n", 100.0 * quantiles[i],
+                            exact, value);
+            }
+        }
+    }
+
+    checkasm_report("histogram");
+}
+
+/* Names that were already tested are skipped without touching any state, so
+ * looking them up again measures the registry overhead of checkasm_check_key()
+ * itself: formatting the name and finding the node */
+#define REGISTRY_NAMES 256
+
+static void registry_lookup(int count)
+{
+    for (int i = 0; i < count; i++)
+        checkasm_check_key((CheckasmKey) checkasm_rand, "registry_%d", i);
+}
+
+static void selftest_test_registry(void)
+{
+    for (int i = 0; i < REGISTRY_NAMES; i++)
+        checkasm_check_key((CheckasmKey) checkasm_rand, "registry_%d", i);
+
+    if (checkasm_check_func(registry_lookup, "registry_lookup")) {
+        checkasm_declare(void, int count);
+        checkasm_bench_set_work(0, REGISTRY_NAMES);
+        checkasm_bench_new(REGISTRY_NAMES);
+    }
+
+    checkasm_report("registry");
+}
+
 void selftest_check_utils(void)
 {
     selftest_test_prng();
     selftest_test_randomize();
     selftest_test_clear();
     selftest_test_init();
+    selftest_test_compare();
+    selftest_test_histogram();
+    selftest_test_registry();
 }